@@ -25,14 +25,16 @@ using namespace std;
 #define DEF_TMP_DIR          "./"
 
 #define TMP_FILE_NAME        ".noxim_explorer.tmp"
+#define RESULTS_FILE_NAME    ".noxim_explorer.json"
 
-#define RPACKETS_LABEL       "% Total received packets:"
-#define RFLITS_LABEL         "% Total received flits:"
-#define AVG_DELAY_LABEL      "% Global average delay (cycles):"
-#define AVG_THROUGHPUT_LABEL "% Network throughput (flits/cycle):"
-#define THROUGHPUT_LABEL     "% Average IP throughput (flits/cycle/IP):"
-#define MAX_DELAY_LABEL      "% Max delay (cycles):"
-#define TOTAL_ENERGY_LABEL   "% Total energy (J):"
+// Fields of the results written by noxim -results
+#define RPACKETS_KEY         "received_packets"
+#define RFLITS_KEY           "received_flits"
+#define AVG_DELAY_KEY        "average_delay"
+#define AVG_THROUGHPUT_KEY   "network_throughput"
+#define THROUGHPUT_KEY       "ip_throughput"
+#define MAX_DELAY_KEY        "max_delay"
+#define TOTAL_ENERGY_KEY     "total_energy"
 
 #define MATLAB_VAR_NAME      "data"
 #define MATRIX_COLUMN_WIDTH  15
@@ -539,6 +541,8 @@ bool PrintMatlabFunction(const string& mfname,
 
 //---------------------------------------------------------------------------
 
+// Reads the top level fields of the results, one per line as in
+//   "key": value,
 bool ReadResults(const string& fname, 
 		 TSimulationResults& sres, 
 		 string& error_msg)
@@ -551,74 +555,34 @@ bool ReadResults(const string& fname,
     }
 
   int nread = 0;
-  while (!fin.eof())
+  string line;
+  while (getline(fin, line))
     {
-      string line;
-      getline(fin, line);
-
-      size_t pos;      
-      pos = line.find(RPACKETS_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(RPACKETS_LABEL).size()));
-	  iss >> sres.rpackets;
-	  continue;
-	}
-      
-      pos = line.find(RFLITS_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(RFLITS_LABEL).size()));
-	  iss >> sres.rflits;
-	  continue;
-	}
-
-      pos = line.find(AVG_DELAY_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(AVG_DELAY_LABEL).size()));
-	  iss >> sres.avg_delay;
-	  continue;
-	}
-
-      pos = line.find(AVG_THROUGHPUT_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(AVG_THROUGHPUT_LABEL).size()));
-	  iss >> sres.avg_throughput;
-	  continue;
-	}
-
-      pos = line.find(THROUGHPUT_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(THROUGHPUT_LABEL).size()));
-	  iss >> sres.throughput;
-	  continue;
-	}
-
-      pos = line.find(MAX_DELAY_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(MAX_DELAY_LABEL).size()));
-	  iss >> sres.max_delay;
-	  continue;
-	}
+      size_t pos = line.find("\": ");
+      if (line.compare(0, 3, "  \"") != 0 || pos == string::npos)
+	continue;
+
+      string key = line.substr(3, pos - 3);
+      istringstream iss(line.substr(pos + 3));
+
+      if (key == RPACKETS_KEY)
+	iss >> sres.rpackets;
+      else if (key == RFLITS_KEY)
+	iss >> sres.rflits;
+      else if (key == AVG_DELAY_KEY)
+	iss >> sres.avg_delay;
+      else if (key == AVG_THROUGHPUT_KEY)
+	iss >> sres.avg_throughput;
+      else if (key == THROUGHPUT_KEY)
+	iss >> sres.throughput;
+      else if (key == MAX_DELAY_KEY)
+	iss >> sres.max_delay;
+      else if (key == TOTAL_ENERGY_KEY)
+	iss >> sres.total_energy;
+      else
+	continue;
 
-      pos = line.find(TOTAL_ENERGY_LABEL);
-      if (pos != string::npos) 
-	{
-	  nread++;
-	  istringstream iss(line.substr(pos + string(TOTAL_ENERGY_LABEL).size()));
-	  iss >> sres.total_energy;
-	  continue;
-	}
+      nread++;
     }
 
   if (nread != 7)
@@ -638,15 +602,19 @@ bool RunSimulation(const string& cmd_base,
 		   string& error_msg)
 {
   string tmp_fname = tmp_dir + TMP_FILE_NAME;
+  string results_fname = tmp_dir + RESULTS_FILE_NAME;
   //  string cmd = cmd_base + " >& " + tmp_fname; // this works only with csh and bash
-  string cmd = cmd_base + " >" + tmp_fname + " 2>&1"; // this works with sh, csh, and bash!
+  string cmd = cmd_base + " -results " + results_fname + " >" + tmp_fname + " 2>&1"; // this works with sh, csh, and bash!
+
+  // the results of a previous simulation are not read if this one fails
+  string rm_cmd = string("rm -f ") + tmp_fname + " " + results_fname;
+  system(rm_cmd.c_str());
 
   cout << cmd << endl;
   system(cmd.c_str());
-  if (!ReadResults(tmp_fname, sres, error_msg))
+  if (!ReadResults(results_fname, sres, error_msg))
     return false;
 
-  string rm_cmd = string("rm -f ") + tmp_fname;
   system(rm_cmd.c_str());
 
   return true;
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <string.h>
+
+using namespace std;
+
+// Must match src/GlobalParams.h and src/GlobalRoutingTable.h
+#define DIRECTION_NORTH         0
+#define DIRECTION_EAST          1
+#define DIRECTION_SOUTH         2
+#define DIRECTION_WEST          3
+#define DIRECTION_LOCAL         4
+
+#define COLUMN_AOC              22
+
+#define ROUTING_TABLE_MAGIC     "NXRT"
+#define ROUTING_TABLE_VERSION   1
+#define ROUTING_TABLE_INPUTS    (DIRECTION_LOCAL + 1)
+
+struct CompiledRoutingTableHeader {
+  char magic[4];
+  unsigned int version;
+  unsigned int mesh_dim_x;
+  unsigned int mesh_dim_y;
+};
+
+int dim_x, dim_y;
+
+//---------------------------------------------------------------------------
+
+// Direction, as seen from node dst, of the link src->dst (input link) or,
+// if output is true, from node src of the link src->dst (output link)
+int LinkDirection(int src, int dst, bool output)
+{
+  int from = output ? src : dst;
+  int to = output ? dst : src;
+
+  if (to == from)
+    return DIRECTION_LOCAL;
+  else if (to == from + 1)
+    return DIRECTION_EAST;
+  else if (to == from - 1)
+    return DIRECTION_WEST;
+  else if (to == from - dim_x)
+    return DIRECTION_NORTH;
+  else if (to == from + dim_x)
+    return DIRECTION_SOUTH;
+
+  cerr << "Error: " << src << "->" << dst << " is not a link of a "
+       << dim_x << "x" << dim_y << " mesh" << endl;
+  exit(1);
+}
+
+//---------------------------------------------------------------------------
+
+bool CompileRoutingTable(char* rt_fname, char* bin_fname)
+{
+  ifstream fin(rt_fname, ios::in);
+  if (!fin)
+    {
+      cerr << "Cannot open " << rt_fname << endl;
+      return false;
+    }
+
+  int n_nodes = dim_x * dim_y;
+  vector<unsigned char> entries((size_t)n_nodes * ROUTING_TABLE_INPUTS * n_nodes, 0);
+  int n_entries = 0;
+
+  bool stop = false;
+  while (!fin.eof() && !stop)
+    {
+      char line[128];
+      fin.getline(line, sizeof(line)-1);
+
+      if (line[0] == '\0')
+	stop = true;
+      else if (line[0] != '%')
+	{
+	  int node_id, in_src, in_dst, dst_id, out_src, out_dst;
+
+	  if (sscanf(line+1, "%d %d->%d %d", &node_id, &in_src, &in_dst, &dst_id) == 4)
+	    {
+	      if (node_id < 0 || node_id >= n_nodes || dst_id < 0 || dst_id >= n_nodes)
+		{
+		  cerr << "Error: node out of the mesh in line '" << line << "'" << endl;
+		  return false;
+		}
+
+	      int in_dir = LinkDirection(in_src, in_dst, false);
+	      unsigned char& mask = entries[((size_t)node_id * ROUTING_TABLE_INPUTS + in_dir) * n_nodes + dst_id];
+
+	      char* pstr = line + COLUMN_AOC;
+	      while (pstr && sscanf(pstr, "%d->%d", &out_src, &out_dst) == 2)
+		{
+		  mask |= 1 << LinkDirection(out_src, out_dst, true);
+
+		  pstr = strstr(pstr, ",");
+		  if (pstr)
+		    pstr++;
+		}
+
+	      n_entries++;
+	    }
+	}
+    }
+
+  ofstream fout(bin_fname, ios::out | ios::binary);
+  if (!fout)
+    {
+      cerr << "Cannot write " << bin_fname << endl;
+      return false;
+    }
+
+  CompiledRoutingTableHeader header;
+  memcpy(header.magic, ROUTING_TABLE_MAGIC, sizeof(header.magic));
+  header.version = ROUTING_TABLE_VERSION;
+  header.mesh_dim_x = dim_x;
+  header.mesh_dim_y = dim_y;
+
+  fout.write((const char*)&header, sizeof(header));
+  fout.write((const char*)&entries[0], entries.size());
+
+  cout << n_entries << " entries of " << rt_fname << " compiled to " << bin_fname
+       << " (" << sizeof(header) + entries.size() << " bytes)" << endl;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  if (argc != 5 || (dim_x = atoi(argv[1])) <= 0 || (dim_y = atoi(argv[2])) <= 0)
+    {
+      cout << "Use " << argv[0] << " <mesh dim x> <mesh dim y> <routing table> <compiled routing table>" << endl;
+      return 1;
+    }
+
+  if (!CompileRoutingTable(argv[3], argv[4]))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+#!/bin/bash
+#
+# Measures the throughput (simulated cycles per second) of the default
+# SystemC kernel, of the fast kernel (-fast_kernel) and of the parallel
+# simulation for 1..N threads, and checks that every run gives the same
+# results as the default one. This is done for each routing algorithm and
+# selection strategy of SCENARIOS, as the buffer level and NoP selections
+# depend on the order in which the router updates them. The exit status
+# is 1 if any run gives different results.
+#
+# Usage: ./scaling_benchmark.sh [MAX_THREADS] [extra noxim options]
+# e.g.   ./scaling_benchmark.sh 16 -dimx 128 -dimy 128
+#
+# Run from the bin directory (or set NOXIM) so that noxim finds its
+# default configuration files.
+
+NOXIM=${NOXIM:-./noxim}
+OUT_FOLDER=${OUT_FOLDER:-scaling}
+
+if [ $# -eq 0 ]
+then
+    MAX_THREADS=`nproc`
+else
+    MAX_THREADS=$1
+    shift
+fi
+
+DIMX=64
+DIMY=64
+SIM=10000
+SEED=0
+SCENARIOS=${SCENARIOS:-"XY:RANDOM ODD_EVEN:BUFFER_LEVEL ODD_EVEN:NOP"}
+
+mkdir -p $OUT_FOLDER
+
+# Runs noxim with the options following the name of the run, and prints
+# its throughput and speedup over the default kernel
+run()
+{
+    NAME=$1
+    shift
+    OUT=$OUT_FOLDER/${ROUTING}_${SEL}_$NAME.txt
+
+    START=`date +%s.%N`
+    $NOXIM -dimx $DIMX -dimy $DIMY -sim $SIM -seed $SEED -routing $ROUTING -sel $SEL \
+        "${EXTRA[@]}" "$@" > $OUT 2>&1
+    exitcode=$?
+    END=`date +%s.%N`
+
+    if [ $exitcode -ne 0 ]
+    then
+        echo "$NAME: noxim failed, see $OUT"
+        exit 1
+    fi
+
+    # reset and simulation cycles both go through the kernel
+    CYCLES=`grep "cycles executed" $OUT | sed 's/.*(\([0-9]*\) cycles executed).*/\1/'`
+    ELAPSED=`awk "BEGIN { print $END - $START }"`
+
+    if [ $NAME = default ]
+    then
+        BASE_SECONDS=$ELAPSED
+        RESULTS="reference"
+    elif diff -q -I "threads" $OUT_FOLDER/${ROUTING}_${SEL}_default.txt $OUT > /dev/null
+    then
+        RESULTS="identical"
+    else
+        RESULTS="DIFFERENT"
+        STATUS=1
+    fi
+
+    awk "BEGIN { printf \"%-12s %8.2f %9.0f %8.2f  %s\\n\", \"$NAME\", $ELAPSED, \
+        $CYCLES / $ELAPSED, $BASE_SECONDS / $ELAPSED, \"$RESULTS\" }"
+}
+
+EXTRA=("$@")
+STATUS=0
+
+for SCENARIO in $SCENARIOS
+do
+    ROUTING=${SCENARIO%:*}
+    SEL=${SCENARIO#*:}
+
+    echo "-routing $ROUTING -sel $SEL"
+    echo "kernel        seconds  cycles/s  speedup  results"
+
+    run default
+    run fast_kernel -fast_kernel
+
+    for THREADS in `seq 1 $MAX_THREADS`
+    do
+        run threads_$THREADS -threads $THREADS
+    done
+
+    echo
+done
+
+exit $STATUS
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <string.h>
+#include <stdint.h>
+
+using namespace std;
+
+// Must match src/TrafficTrace.h
+#define TRAFFIC_TRACE_MAGIC     "NXTR"
+#define TRAFFIC_TRACE_VERSION   1
+
+struct TraceHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t n_sources;
+  uint32_t reserved;
+};
+
+struct TraceSection {
+  uint64_t first;
+  uint64_t count;
+};
+
+struct TraceRecord {
+  uint32_t cycle;
+  uint16_t dst_id;
+  uint16_t size;
+};
+
+// Records of a source kept in memory before being written to its section
+#define RECORDS_PER_FLUSH       512
+
+//---------------------------------------------------------------------------
+
+// Parses the next packet of the trace, skipping comments and empty lines
+bool NextPacket(ifstream& fin, long& line_no, unsigned long& cycle,
+                int& src, int& dst, int& size)
+{
+  char line[256];
+
+  while (true)
+    {
+      // a line filling the buffer stops getline without reaching the end
+      if (!fin.getline(line, sizeof(line)))
+        {
+          if (fin.eof())
+            return false;
+
+          cerr << "Error: line " << line_no + 1 << " is longer than "
+               << sizeof(line) - 1 << " characters" << endl;
+          exit(1);
+        }
+
+      line_no++;
+
+      if (line[0] == '%' || strspn(line, " \t\r") == strlen(line))
+        continue;
+
+      int fields = sscanf(line, "%lu %d %d %d", &cycle, &src, &dst, &size);
+      if (fields != 4 ||
+          src < 0 || src > UINT16_MAX || dst < 0 || dst > UINT16_MAX ||
+          size < 2 || size > UINT16_MAX || cycle > UINT32_MAX)
+        {
+          cerr << "Error: invalid packet at line " << line_no << ": '" << line << "'" << endl;
+          if (fields == 4 && size < 2)
+            cerr << "packet size must be >= 2" << endl;
+          exit(1);
+        }
+
+      return true;
+    }
+}
+
+//---------------------------------------------------------------------------
+
+// Writes the pending records of a source after those already written
+void Flush(fstream& fout, streamoff records_offset, const TraceSection& section,
+           vector<TraceRecord>& pending, uint64_t& written)
+{
+  if (pending.empty())
+    return;
+
+  fout.seekp(records_offset + (section.first + written) * sizeof(TraceRecord));
+  fout.write((const char*)&pending[0], pending.size() * sizeof(TraceRecord));
+  written += pending.size();
+  pending.clear();
+}
+
+//---------------------------------------------------------------------------
+
+bool CompileTrace(char* trace_fname, char* bin_fname)
+{
+  unsigned long cycle;
+  int src, dst, size;
+  long line_no;
+
+  // first pass: number of packets of each source
+  ifstream fin(trace_fname, ios::in);
+  if (!fin)
+    {
+      cerr << "Cannot open " << trace_fname << endl;
+      return false;
+    }
+
+  vector<TraceSection> sections;
+  vector<unsigned long> last_cycle;
+
+  line_no = 0;
+  while (NextPacket(fin, line_no, cycle, src, dst, size))
+    {
+      if (src >= (int)sections.size())
+        {
+          TraceSection empty = { 0, 0 };
+          sections.resize(src + 1, empty);
+          last_cycle.resize(src + 1, 0);
+        }
+
+      if (cycle < last_cycle[src])
+        {
+          cerr << "Error: the packets of " << src << " are not sorted by cycle at line "
+               << line_no << endl;
+          return false;
+        }
+
+      last_cycle[src] = cycle;
+      sections[src].count++;
+    }
+
+  uint64_t n_packets = 0;
+  for (unsigned int i = 0; i < sections.size(); i++)
+    {
+      sections[i].first = n_packets;
+      n_packets += sections[i].count;
+    }
+
+  fstream fout(bin_fname, ios::in | ios::out | ios::binary | ios::trunc);
+  if (!fout)
+    {
+      cerr << "Cannot write " << bin_fname << endl;
+      return false;
+    }
+
+  TraceHeader header;
+  memcpy(header.magic, TRAFFIC_TRACE_MAGIC, sizeof(header.magic));
+  header.version = TRAFFIC_TRACE_VERSION;
+  header.n_sources = sections.size();
+  header.reserved = 0;
+
+  fout.write((const char*)&header, sizeof(header));
+  if (!sections.empty())
+    fout.write((const char*)&sections[0], sections.size() * sizeof(TraceSection));
+
+  streamoff records_offset = fout.tellp();
+
+  // second pass: the packets of each source are buffered and written to
+  // their section, so that the memory used does not depend on the trace
+  fin.clear();
+  fin.seekg(0);
+
+  vector<vector<TraceRecord> > pending(sections.size());
+  vector<uint64_t> written(sections.size(), 0);
+
+  line_no = 0;
+  while (NextPacket(fin, line_no, cycle, src, dst, size))
+    {
+      TraceRecord record;
+      record.cycle = cycle;
+      record.dst_id = dst;
+      record.size = size;
+      pending[src].push_back(record);
+
+      if (pending[src].size() == RECORDS_PER_FLUSH)
+        Flush(fout, records_offset, sections[src], pending[src], written[src]);
+    }
+
+  for (unsigned int s = 0; s < pending.size(); s++)
+    Flush(fout, records_offset, sections[s], pending[s], written[s]);
+
+  if (!fout)
+    {
+      cerr << "Error writing " << bin_fname << endl;
+      return false;
+    }
+
+  cout << n_packets << " packets of " << sections.size() << " sources of " << trace_fname
+       << " compiled to " << bin_fname << endl;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  if (argc != 3)
+    {
+      cout << "Use " << argv[0] << " <packet trace> <compiled packet trace>" << endl
+           << "Each line of the packet trace is: <cycle> <source> <destination> <size in flits>" << endl
+           << "where cycles are counted from the end of the reset" << endl;
+      return 1;
+    }
+
+  if (!CompileTrace(argv[1], argv[2]))
+    return 1;
+
+  return 0;
+}
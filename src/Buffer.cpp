@@ -13,6 +13,10 @@
 
 Buffer::Buffer()
 {
+  ring = NULL;
+  ring_mask = 0;
+  head = 0;
+  count = 0;
   SetMaxBufferSize(GlobalParams::buffer_depth);
   max_occupancy = 0;
   hold_time = 0.0;
@@ -40,8 +44,6 @@ string Buffer::getLabel() const
 
 void Buffer::Print()
 {
-    queue<Flit> m = buffer;
-
     string bstr = "";
    
 
@@ -49,11 +51,10 @@ void Buffer::Print()
 
     cout << sc_time_stamp().to_double() / GlobalParams::clock_period_ps << "\t";
     cout << label << " QUEUE *[";
-    while (!(m.empty()))
+    for (unsigned int i = 0; i < count; i++)
     {
-	Flit f = m.front();
-	m.pop();
-	cout << bstr << t[f.flit_type] << f.sequence_no <<  "(" << f.dst_id << ") | ";
+	const Flit & f = ring[(head + i) & ring_mask];
+	cout << bstr << t[f.flit_type] << f.sequence_no <<  "(" << f.packet().dst_id << ") | ";
     }
     cout << "]*" << endl;
     cout << endl;
@@ -67,8 +68,7 @@ void Buffer::deadlockCheck()
 
     if (IsEmpty()) return;
 
-    Flit f = buffer.front();
-    int seq = f.sequence_no;
+    int seq = Front().sequence_no;
 
     if (last_front_flit_seq==seq)
     {
@@ -98,9 +98,7 @@ bool Buffer::deadlockFree()
 {
     if (IsEmpty()) return true;
 
-    Flit f = buffer.front();
-    
-    int seq = f.sequence_no;
+    int seq = Front().sequence_no;
 
 
     if (last_front_flit_seq==seq)
@@ -132,6 +130,44 @@ void Buffer::SetMaxBufferSize(const unsigned int bms)
   assert(bms > 0);
 
   max_buffer_size = bms;
+
+  // a ring too small is given up, a new one is allocated at the next Push
+  if (ring != NULL && RingCapacity(bms) > ring_mask + 1)
+  {
+    assert(IsEmpty());
+    ring = NULL;
+    vector < Flit > ().swap(own_ring);
+  }
+}
+
+unsigned int Buffer::RingCapacity(const unsigned int max_size)
+{
+  unsigned int capacity = 1;
+
+  while (capacity < max_size)
+    capacity <<= 1;
+
+  return capacity;
+}
+
+void Buffer::SetStorage(Flit * storage, const unsigned int capacity)
+{
+  assert(IsEmpty());
+  assert(capacity >= RingCapacity(max_buffer_size));
+  assert((capacity & (capacity - 1)) == 0);
+
+  ring = storage;
+  ring_mask = capacity - 1;
+  head = 0;
+  vector < Flit > ().swap(own_ring);
+}
+
+void Buffer::AllocateRing()
+{
+  own_ring.assign(RingCapacity(max_buffer_size), Flit());
+  ring = &own_ring[0];
+  ring_mask = own_ring.size() - 1;
+  head = 0;
 }
 
 unsigned int Buffer::GetMaxBufferSize() const
@@ -141,12 +177,12 @@ unsigned int Buffer::GetMaxBufferSize() const
 
 bool Buffer::IsFull() const
 {
-  return buffer.size() == max_buffer_size;
+  return count == max_buffer_size;
 }
 
 bool Buffer::IsEmpty() const
 {
-  return buffer.size() == 0;
+  return count == 0;
 }
 
 void Buffer::Drop(const Flit & flit) const
@@ -165,48 +201,48 @@ void Buffer::Push(const Flit & flit)
 
   if (IsFull())
     Drop(flit);
-  else
-    buffer.push(flit);
+  else {
+    if (ring == NULL)
+      AllocateRing();
+    ring[(head + count) & ring_mask] = flit;
+    count++;
+  }
   
   UpdateMeanOccupancy();
 
-  if (max_occupancy < buffer.size())
-    max_occupancy = buffer.size();
+  if (max_occupancy < count)
+    max_occupancy = count;
 }
 
-Flit Buffer::Pop()
+void Buffer::Pop()
 {
-  Flit f;
-
   SaveOccupancyAndTime();
 
   if (IsEmpty())
     Empty();
   else {
-    f = buffer.front();
-    buffer.pop();
+    head = (head + 1) & ring_mask;
+    count--;
   }
 
   UpdateMeanOccupancy();
-
-  return f;
 }
 
-Flit Buffer::Front() const
+const Flit & Buffer::Front() const
 {
-  Flit f;
+  if (IsEmpty()) {
+    static const Flit empty_flit = Flit();
 
-  if (IsEmpty())
     Empty();
-  else
-    f = buffer.front();
+    return empty_flit;
+  }
 
-  return f;
+  return ring[head];
 }
 
 unsigned int Buffer::Size() const
 {
-  return buffer.size();
+  return count;
 }
 
 unsigned int Buffer::getCurrentFreeSlots() const
@@ -216,7 +252,7 @@ unsigned int Buffer::getCurrentFreeSlots() const
 
 void Buffer::SaveOccupancyAndTime()
 {
-  previous_occupancy = buffer.size();
+  previous_occupancy = count;
   hold_time = (sc_time_stamp().to_double() / GlobalParams::clock_period_ps) - last_event;
   last_event = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
 }
@@ -227,12 +263,26 @@ void Buffer::UpdateMeanOccupancy()
   if (current_time - GlobalParams::reset_time < GlobalParams::stats_warm_up_time)
     return;
 
+  // the occupancy before the event held since the previous one
+  if (hold_time_sum + hold_time == 0.0)
+    return;
+
   mean_occupancy = mean_occupancy * (hold_time_sum/(hold_time_sum+hold_time)) +
-    (1.0/(hold_time_sum+hold_time)) * hold_time * buffer.size();
+    (1.0/(hold_time_sum+hold_time)) * hold_time * previous_occupancy;
 
   hold_time_sum += hold_time;
 }
 
+double Buffer::getMeanOccupancy() const
+{
+  return mean_occupancy;
+}
+
+unsigned int Buffer::getMaxOccupancy() const
+{
+  return max_occupancy;
+}
+
 void Buffer::ShowStats(std::ostream & out)
 {
   if (true_buffer)
@@ -12,10 +12,14 @@
 #define __NOXIMBUFFER_H__
 
 #include <cassert>
-#include <queue>
+#include <vector>
 #include "DataStructs.h"
 using namespace std;
 
+// FIFO of flits stored in a ring whose capacity is the power of two
+// following the max buffer size. The ring is either carved from an
+// arena shared with other buffers (see SetStorage) or allocated by the
+// buffer itself at the first Push
 class Buffer {
 
   public:
@@ -39,14 +43,18 @@ class Buffer {
 
     void Push(const Flit & flit);	// Push a flit. Calls Drop method if buffer is full
 
-    Flit Pop();		// Pop a flit
+    void Pop();		// Pop a flit
 
-    Flit Front() const;	// Return a copy of the first flit in the buffer
+    const Flit & Front() const;	// Return the first flit in the buffer, valid until the next Pop()
 
     unsigned int Size() const;
 
     void ShowStats(std::ostream & out);
 
+    double getMeanOccupancy() const;	// Time-weighted mean number of flits
+
+    unsigned int getMaxOccupancy() const;
+
     void Disable();
 
 
@@ -59,8 +67,18 @@ class Buffer {
     void setLabel(string);
     string getLabel() const;
 
+    // Ring capacity needed to hold max_size flits
+    static unsigned int RingCapacity(const unsigned int max_size);
+
+    // Uses capacity slots (at least RingCapacity(GetMaxBufferSize())) of
+    // an external arena as ring. The buffer must be empty
+    void SetStorage(Flit * storage, const unsigned int capacity);
+
   private:
 
+    Buffer(const Buffer &);	// the ring may point to an external arena
+    Buffer & operator=(const Buffer &);
+
     bool true_buffer;
     bool deadlock_detected;
 
@@ -71,7 +89,11 @@ class Buffer {
 
     unsigned int max_buffer_size;
 
-    queue < Flit > buffer;
+    Flit * ring;		// NULL until allocated or set
+    unsigned int ring_mask;	// ring capacity - 1
+    unsigned int head;		// index of the first flit in the ring
+    unsigned int count;		// number of flits in the buffer
+    vector < Flit > own_ring;	// storage when not set from an arena
 
     unsigned int max_occupancy;
     double hold_time, last_event, hold_time_sum;
@@ -80,6 +102,7 @@ class Buffer {
     
     void SaveOccupancyAndTime();
     void UpdateMeanOccupancy();
+    void AllocateRing();
 };
 
 typedef Buffer BufferBank[MAX_VIRTUAL_CHANNELS];
@@ -45,6 +45,51 @@ void Channel::b_transport( int id, tlm::tlm_generic_payload& trans, sc_time& del
     }
 }
 
+tlm::tlm_sync_enum Channel::nb_transport_fw( int id, tlm::tlm_generic_payload& trans,
+                                             tlm::tlm_phase& phase, sc_time& delay )
+{
+    assert (id < (int)targ_socket.size());
+    assert (phase == tlm::BEGIN_REQ);
+
+    sc_dt::uint64 masked_address;
+    unsigned int target_nr = decode_address( trans.get_address(), masked_address);
+    assert (target_nr < init_socket.size());
+
+    accountWirelessRxPower();
+
+    powerManager(target_nr,trans);
+
+    // the flit is delivered when its transmission is over, as b_transport
+    // would do after wait(), but without suspending the initiator. The
+    // payload is held until then
+    trans.acquire();
+    m_id_map[&trans] = id;
+    peq.notify(trans, phase, delay + sc_time(this->cc_flit_transmission_delay_ps, SC_PS));
+
+    return tlm::TLM_ACCEPTED;
+}
+
+// The transmission of a flit is over: it is forwarded to its target and
+// the response is returned to the initiator
+void Channel::peq_cb(tlm::tlm_generic_payload& trans, const tlm::tlm_phase& phase)
+{
+    sc_dt::uint64 address = trans.get_address();
+    sc_dt::uint64 masked_address;
+    unsigned int target_nr = decode_address( address, masked_address);
+    sc_time delay = SC_ZERO_TIME;
+
+    trans.set_address( masked_address );
+    init_socket[target_nr]->b_transport(trans, delay);
+    trans.set_address( address );
+
+    unsigned int id = m_id_map[&trans];
+    m_id_map.erase(&trans);
+
+    tlm::tlm_phase resp_phase = tlm::BEGIN_RESP;
+    targ_socket[id]->nb_transport_bw(trans, resp_phase, delay);
+
+    trans.release();
+}
 
 void Channel::accountWirelessRxPower()
 {
@@ -67,7 +112,7 @@ void Channel::powerManager(unsigned int hub_dst_index, tlm::tlm_generic_payload&
 
     if (f->flit_type==FLIT_TYPE_HEAD)
     {
-	int sleep_cycles = flit_transmission_cycles * f->sequence_length;
+	int sleep_cycles = flit_transmission_cycles * f->packet().sequence_length;
 
 	for (unsigned int i = 0; i<hubs.size();i++)
 	{
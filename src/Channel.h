@@ -52,10 +52,12 @@ struct Channel: sc_module
   int local_id; // Unique ID
 
   Channel(sc_module_name nm, int id)
-  : sc_module(nm), targ_socket("targ_socket"), init_socket("init_socket")
+  : sc_module(nm), targ_socket("targ_socket"), init_socket("init_socket"),
+    peq("peq", this, &Channel::peq_cb)
   {
     local_id = id;
     targ_socket.register_b_transport(       this, &Channel::b_transport);
+    targ_socket.register_nb_transport_fw(   this, &Channel::nb_transport_fw);
     targ_socket.register_get_direct_mem_ptr(this, &Channel::get_direct_mem_ptr);
     targ_socket.register_transport_dbg(     this, &Channel::transport_dbg);
 
@@ -80,6 +82,11 @@ struct Channel: sc_module
   // Tagged TLM-2 blocking transport method
   virtual void b_transport( int id, tlm::tlm_generic_payload& trans, sc_time& delay );
 
+  // Tagged TLM-2 non-blocking transport method, the flit is delivered
+  // to the target after the same delay as b_transport
+  virtual tlm::tlm_sync_enum nb_transport_fw( int id, tlm::tlm_generic_payload& trans,
+                                              tlm::tlm_phase& phase, sc_time& delay );
+
   // Tagged TLM-2 forward DMI method
   virtual bool get_direct_mem_ptr(int id,
                                   tlm::tlm_generic_payload& trans,
@@ -129,6 +136,10 @@ struct Channel: sc_module
 
   std::map <tlm::tlm_generic_payload*, unsigned int> m_id_map;
 
+  // flits on the air with the non-blocking transport
+  tlm_utils::peq_with_cb_and_phase<Channel> peq;
+  void peq_cb(tlm::tlm_generic_payload& trans, const tlm::tlm_phase& phase);
+
    void powerManager(unsigned int hub_dst_index, tlm::tlm_generic_payload& trans);
    void accountWirelessRxPower();
 
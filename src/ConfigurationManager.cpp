@@ -78,6 +78,8 @@ void loadConfiguration() {
     GlobalParams::probability_of_retransmission = readParam<double>(config, "probability_of_retransmission");
     GlobalParams::traffic_distribution = readParam<string>(config, "traffic_distribution");
     GlobalParams::traffic_table_filename = readParam<string>(config, "traffic_table_filename");
+    GlobalParams::traffic_trace_filename = readParam<string>(config, "traffic_trace_filename", "");
+    GlobalParams::traffic_matrix_filename = readParam<string>(config, "traffic_matrix_filename", "");
     GlobalParams::clock_period_ps = readParam<int>(config, "clock_period_ps");
     GlobalParams::simulation_time = readParam<int>(config, "simulation_time");
     GlobalParams::n_virtual_channels = readParam<int>(config, "n_virtual_channels");
@@ -91,7 +93,17 @@ void loadConfiguration() {
     GlobalParams::show_buffer_stats = readParam<bool>(config, "show_buffer_stats");
     GlobalParams::use_winoc = readParam<bool>(config, "use_winoc");
     GlobalParams::winoc_dst_hops = readParam<int>(config, "winoc_dst_hops",0);
+    GlobalParams::winoc_nb_transport = readParam<bool>(config, "winoc_nb_transport", false);
     GlobalParams::use_powermanager = readParam<bool>(config, "use_wirxsleep");
+    GlobalParams::fast_kernel = readParam<bool>(config, "fast_kernel", false);
+    GlobalParams::parallel_threads = readParam<int>(config, "parallel_threads", 0);
+    GlobalParams::geometric_injection = readParam<bool>(config, "geometric_injection", false);
+    GlobalParams::route_timeout = readParam<int>(config, "route_timeout", 0);
+    GlobalParams::telemetry_interval = readParam<int>(config, "telemetry_interval", 0);
+    GlobalParams::telemetry_filename = readParam<string>(config, "telemetry_filename", "telemetry.csv");
+    GlobalParams::heatmap_filename = readParam<string>(config, "heatmap_filename", "");
+    GlobalParams::latency_breakdown = readParam<bool>(config, "latency_breakdown", false);
+    GlobalParams::results_filename = readParam<string>(config, "results_filename", "");
     
 
     set<int> channelSet;
@@ -203,6 +215,7 @@ void showHelp(char selfname[])
 	 << "\t-vc N\t\t\tNumber of virtual channels" << endl
          << "\t-winoc\t\t\tEnable radio hub wireless transmission" << endl
          << "\t-winoc_dst_hops\t\t\tMax number of hops between target RadioHub and destination node" << endl
+         << "\t-winoc_nb\t\tTransmit the wireless flits from methods with non-blocking transport instead of threads (same results)" << endl
          << "\t-wirxsleep\t\tEnable radio hub wireless power manager" << endl
          << "\t-size Nmin Nmax\t\tSet the minimum and maximum packet size [flits]" << endl
          << "\t-flit N\t\t\tSet the flit size [bit]" << endl
@@ -218,16 +231,20 @@ void showHelp(char selfname[])
          << "\t\tNEGATIVE_FIRST\tNegative-First routing algorithm" << endl
          << "\t\tODD_EVEN\tOdd-Even routing algorithm" << endl
          << "\t\tDYAD T\t\tDyAD routing algorithm with threshold T" << endl
-         << "\t\tTABLE_BASED FILENAME\tRouting Table Based routing algorithm with table in the specified file" << endl
+         << "\t\tTABLE_BASED FILENAME\tRouting Table Based routing algorithm with table in the specified file (text, or compiled with other/rt2bin)" << endl
          << "\t-sel TYPE\t\tSet the selection strategy to one of the following:" << endl
          << "\t\tRANDOM\t\tRandom selection strategy" << endl
          << "\t\tBUFFER_LEVEL\tBuffer-Level Based selection strategy" << endl
          << "\t\tNOP\t\tNeighbors-on-Path selection strategy" << endl
+         << "\t-route_timeout N\tRoute a head flit once, then again only after N cycles without reservation" << endl
+         << "\t\t\t\t(0: every cycle until reserved, as in the original model)" << endl
          <<	"\t-pir R TYPE\t\tSet the packet injection rate R [0..1] and the time distribution TYPE where TYPE is one of the following:" << endl
          << "\t\tpoisson\t\tMemory-less Poisson distribution" << endl
          << "\t\tburst R\t\tBurst distribution with given real burstness" << endl
          << "\t\tpareto on off r\tSelf-similar Pareto distribution with given real parameters (alfa-on alfa-off r)" << endl
          << "\t\tcustom R\tCustom distribution with given real probability of retransmission" << endl
+         << "\t-geometric_injection\tSample the cycle of the next injection in advance instead of drawing at every cycle" << endl
+         << "\t\t\t\t(same traffic statistics, different random sequence)" << endl
          << "\t-traffic TYPE\t\tSet the spatial distribution of traffic to TYPE where TYPE is one of the following:" << endl
          << "\t\trandom\t\tRandom traffic distribution" << endl
          << "\t\tlocal L\t\tRandom traffic with a fraction L (0..1) of packets having a destination connected to the local hub, i.e. not using wireless" << endl
@@ -238,15 +255,23 @@ void showHelp(char selfname[])
          << "\t\tbutterfly\tButterfly traffic distribution" << endl
          << "\t\tshuffle\t\tShuffle traffic distribution" << endl
          <<	"\t\ttable FILENAME\tTraffic Table Based traffic distribution with table in the specified file" << endl
+         << "\t\ttrace FILENAME\tReplay of the packets of a trace compiled by trace2bin" << endl
+         << "\t\tmatrix FILENAME\tRandom traffic with the destinations weighted by the source-destination matrix in the specified file" << endl
          << "\t-hs ID P\t\tAdd node ID to hotspot nodes, with percentage P (0..1) (Only for 'random' traffic)" << endl
          << "\t-warmup N\t\tStart to collect statistics after N cycles" << endl
          << "\t-seed N\t\t\tSet the seed of the random generator (default time())" << endl
          << "\t-detailed\t\tShow detailed statistics" << endl
          << "\t-show_buf_stats\t\tShow buffers statistics" << endl
+         << "\t-latency_breakdown\tShow the components of the latency of the packets (queueing, contention, ...)" << endl
+         << "\t-telemetry N FILENAME\tWrite to the specified CSV file the activity of each router every N cycles" << endl
+         << "\t-heatmap FILENAME\tWrite to the specified file the utilization of each link and router" << endl
+         << "\t-results FILENAME\tWrite the statistics to the specified JSON file" << endl
          << "\t-volume N\t\tStop the simulation when either the maximum number of cycles has been reached or N flits have" << endl
          << "\t\t\t\tbeen delivered" << endl
          << "\t-asciimonitor\t\tShow status of the network while running (experimental)" << endl
          << "\t-sim N\t\t\tRun for the specified simulation time [cycles]" << endl
+         << "\t-fast_kernel\t\tEvaluate the whole NoC from a single clocked process, skipping idle routers and PEs (same results, faster)" << endl
+         << "\t-threads N\t\tPartition the mesh into N regions evaluated in parallel (implies -fast_kernel, same results)" << endl
          << endl
          << "If you find this program useful please don't forget to mention in your paper Maurizio Palesi <maurizio.palesi@unikore.it>" << endl
          <<	"If you find this program useless please feel free to complain with Davide Patti <davide.patti@dieei.unict.it>" << endl
@@ -442,6 +467,44 @@ void checkConfiguration()
 	exit(1);
     }
 
+    if (GlobalParams::route_timeout < 0)
+    {
+	cerr << "Error: route timeout must be positive" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::telemetry_interval < 0)
+    {
+	cerr << "Error: telemetry interval must be positive" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::parallel_threads < 0)
+    {
+	cerr << "Error: number of threads must be positive" << endl;
+	exit(1);
+    }
+    if (GlobalParams::parallel_threads > 0)
+    {
+	if (GlobalParams::topology != TOPOLOGY_MESH)
+	{
+	    cerr << "Error: -threads currently supported only in MESH topology" << endl;
+	    exit(1);
+	}
+	if (GlobalParams::use_winoc)
+	{
+	    cerr << "Error: -threads cannot be used together with -winoc" << endl;
+	    exit(1);
+	}
+	if (GlobalParams::max_volume_to_be_drained > 0)
+	{
+	    cerr << "Error: -threads cannot be used together with -volume" << endl;
+	    exit(1);
+	}
+	// regions are evaluated by the fast kernel
+	GlobalParams::fast_kernel = true;
+    }
+
     if (GlobalParams::ascii_monitor)
     {
 #ifdef DEBUG
@@ -494,6 +557,8 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	    {
             GlobalParams::winoc_dst_hops = atoi(arg_vet[++i]);
 	    }
+	    else if (!strcmp(arg_vet[i], "-winoc_nb")) 
+		GlobalParams::winoc_nb_transport = true;
 	    else if (!strcmp(arg_vet[i], "-wirxsleep")) 
 	    {
 		GlobalParams::use_powermanager = true;
@@ -573,6 +638,14 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		    GlobalParams::traffic_distribution =
 			TRAFFIC_TABLE_BASED;
 		    GlobalParams::traffic_table_filename = arg_vet[++i];
+		} else if (!strcmp(traffic, "trace")) {
+		    GlobalParams::traffic_distribution =
+			TRAFFIC_TRACE;
+		    GlobalParams::traffic_trace_filename = arg_vet[++i];
+		} else if (!strcmp(traffic, "matrix")) {
+		    GlobalParams::traffic_distribution =
+			TRAFFIC_MATRIX;
+		    GlobalParams::traffic_matrix_filename = arg_vet[++i];
 		} else if (!strcmp(traffic, "local")) {
 		    GlobalParams::traffic_distribution = TRAFFIC_LOCAL;
 		    GlobalParams::locality=atof(arg_vet[++i]);
@@ -594,6 +667,8 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		GlobalParams::detailed = true;
 	    else if (!strcmp(arg_vet[i], "-show_buf_stats"))
 		GlobalParams::show_buffer_stats = true;
+	    else if (!strcmp(arg_vet[i], "-latency_breakdown"))
+		GlobalParams::latency_breakdown = true;
 	    else if (!strcmp(arg_vet[i], "-volume"))
 		GlobalParams::max_volume_to_be_drained =
 		    atoi(arg_vet[++i]);
@@ -601,6 +676,23 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		GlobalParams::simulation_time = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-asciimonitor")) 
 		GlobalParams::ascii_monitor = true;
+	    else if (!strcmp(arg_vet[i], "-fast_kernel")) 
+		GlobalParams::fast_kernel = true;
+	    else if (!strcmp(arg_vet[i], "-geometric_injection")) 
+		GlobalParams::geometric_injection = true;
+	    else if (!strcmp(arg_vet[i], "-threads")) 
+		GlobalParams::parallel_threads = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-route_timeout")) 
+		GlobalParams::route_timeout = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-telemetry")) 
+	    {
+		GlobalParams::telemetry_interval = atoi(arg_vet[++i]);
+		GlobalParams::telemetry_filename = arg_vet[++i];
+	    }
+	    else if (!strcmp(arg_vet[i], "-heatmap")) 
+		GlobalParams::heatmap_filename = arg_vet[++i];
+	    else if (!strcmp(arg_vet[i], "-results")) 
+		GlobalParams::results_filename = arg_vet[++i];
 	    else if (!strcmp(arg_vet[i], "-config") || !strcmp(arg_vet[i], "-power"))
 		// -config is managed from configure function
 		// i++ skips the configuration file name 
@@ -13,6 +13,7 @@
 
 #include <systemc.h>
 #include "GlobalParams.h"
+#include "PacketPool.h"
 
 // Coord -- XY coordinates type of the Tile inside the Mesh
 class Coord {
@@ -46,6 +47,7 @@ struct Packet {
     int size;
     int flit_left;		// Number of remaining flits inside the packet
     bool use_low_voltage_path;
+    unsigned int packet_id;	// Descriptor, allocated when the head flit is injected
 
     // Constructors
     Packet() { }
@@ -62,6 +64,7 @@ struct Packet {
 	size = sz;
 	flit_left = sz;
 	use_low_voltage_path = false;
+	packet_id = PACKET_NOT_VALID;
     }
 };
 
@@ -74,6 +77,51 @@ struct RouteData {
     int vc_id;
 };
 
+// DirectionSet -- output directions admitted by a routing function. It
+// lives on the stack, and keeps the directions in the order they have
+// been added, since the selection strategies choose among them by index
+#define MAX_ADMISSIBLE_DIRECTIONS (DIRECTIONS + 2)
+
+struct DirectionSet {
+    int direction[MAX_ADMISSIBLE_DIRECTIONS];
+    int n;
+
+    DirectionSet() : n(0) {}
+
+    inline void push_back(const int d) {
+	assert(n < MAX_ADMISSIBLE_DIRECTIONS);
+	direction[n++] = d;
+    }
+
+    inline unsigned int size() const { return n; }
+    inline void clear() { n = 0; }
+    inline void truncate(const int new_size) { if (new_size < n) n = new_size; }
+    inline int operator [](const int i) const { return direction[i]; }
+
+    // Packed form stored in the routing lookup tables: the number of
+    // directions in bits [2:0], then 3 bits for each direction. The
+    // empty set packs to PACKED_DIRECTIONS_NOT_VALID
+    inline unsigned int pack() const {
+	unsigned int packed = n;
+	for (int i = 0; i < n; i++)
+	{
+	    assert(direction[i] >= 0 && direction[i] < 8);
+	    packed |= direction[i] << (3 * (i + 1));
+	}
+	return packed;
+    }
+
+    static inline DirectionSet unpack(const unsigned int packed) {
+	DirectionSet dirs;
+	dirs.n = packed & 7;
+	for (int i = 0; i < dirs.n; i++)
+	    dirs.direction[i] = (packed >> (3 * (i + 1))) & 7;
+	return dirs;
+    }
+};
+
+#define PACKED_DIRECTIONS_NOT_VALID 0
+
 struct ChannelStatus {
     int free_slots;		// occupied buffer slots
     bool available;		// 
@@ -115,30 +163,23 @@ struct TBufferFullStatus {
     bool mask[MAX_VIRTUAL_CHANNELS];
 };
 
-// Flit -- Flit definition
+// Flit -- Flit definition. The fields that are the same for all the
+// flits of a packet are kept once in the packet descriptor
 struct Flit {
-    int src_id;
-    int dst_id;
-    int vc_id; // Virtual Channel
-    FlitType flit_type;	// The flit type (FLIT_TYPE_HEAD, FLIT_TYPE_BODY, FLIT_TYPE_TAIL)
+    unsigned int packet_id;	// Descriptor of the packet (see PacketPool)
     int sequence_no;		// The sequence number of the flit inside the packet
-    int sequence_length;
-    Payload payload;	// Optional payload
-    double timestamp;		// Unix timestamp at packet generation
-    int hop_no;			// Current number of hops from source to destination
-    bool use_low_voltage_path;
+    FlitType flit_type;	// The flit type (FLIT_TYPE_HEAD, FLIT_TYPE_BODY, FLIT_TYPE_TAIL)
 
-    int hub_relay_node;
+    Flit() : packet_id(PACKET_NOT_VALID), sequence_no(0), flit_type(FLIT_TYPE_HEAD) { }
+
+    inline PacketDescriptor & packet() const {
+	return PacketPool::get(packet_id);
+    }
 
     inline bool operator ==(const Flit & flit) const {
-	return (flit.src_id == src_id && flit.dst_id == dst_id
-		&& flit.flit_type == flit_type
-		&& flit.vc_id == vc_id
+	return (flit.packet_id == packet_id
 		&& flit.sequence_no == sequence_no
-		&& flit.sequence_length == sequence_length
-		&& flit.payload == payload && flit.timestamp == timestamp
-		&& flit.hop_no == hop_no
-		&& flit.use_low_voltage_path == use_low_voltage_path);
+		&& flit.flit_type == flit_type);
 }};
 
 
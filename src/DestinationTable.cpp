@@ -0,0 +1,326 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the destination distributions
+ * of the spatial traffic (random, hotspot, local, ulocal and matrix)
+ */
+
+#include "DestinationTable.h"
+#include "Utils.h"
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+
+// Vose's construction: outcomes are scaled so that their mean weight is
+// 1, then each entry pairs an outcome below the mean with one above it
+bool AliasTable::build(const vector < pair < int, double > > & weights)
+{
+    entries.clear();
+
+    double total = 0.0;
+    for (unsigned int i = 0; i < weights.size(); i++)
+	if (weights[i].second > 0.0)
+	    total += weights[i].second;
+
+    if (total <= 0.0)
+	return false;
+
+    vector < pair < int, double > > scaled;
+    for (unsigned int i = 0; i < weights.size(); i++)
+	if (weights[i].second > 0.0)
+	    scaled.push_back(pair < int, double >(weights[i].first, 0.0));
+
+    int n = scaled.size();
+    vector < int > small, large;
+
+    for (int i = 0, j = 0; i < (int) weights.size(); i++)
+	if (weights[i].second > 0.0)
+	{
+	    scaled[j].second = weights[i].second * n / total;
+	    if (scaled[j].second < 1.0)
+		small.push_back(j);
+	    else
+		large.push_back(j);
+	    j++;
+	}
+
+    entries.resize(n);
+
+    while (!small.empty() && !large.empty())
+    {
+	int s = small.back();
+	int l = large.back();
+
+	small.pop_back();
+	entries[s].threshold = scaled[s].second;
+	entries[s].outcome = scaled[s].first;
+	entries[s].alias = scaled[l].first;
+
+	scaled[l].second -= 1.0 - scaled[s].second;
+	if (scaled[l].second < 1.0)
+	{
+	    large.pop_back();
+	    small.push_back(l);
+	}
+    }
+
+    // what is left has weight 1, up to rounding errors
+    large.insert(large.end(), small.begin(), small.end());
+    for (unsigned int i = 0; i < large.size(); i++)
+    {
+	entries[large[i]].threshold = 1.0;
+	entries[large[i]].outcome = entries[large[i]].alias = scaled[large[i]].first;
+    }
+
+    return true;
+}
+
+bool TrafficMatrix::load(const char *fname)
+{
+    ifstream fin(fname, ios::in);
+    if (!fin)
+	return false;
+
+    weights.clear();
+
+    int n_tiles;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+	n_tiles = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    else
+	n_tiles = GlobalParams::n_delta_tiles;
+
+    char line[512];
+    while (fin.getline(line, sizeof(line) - 1))
+    {
+	int src, dst;
+	double weight;
+
+	char first;
+
+	// Blank lines and comments
+	if (sscanf(line, " %c", &first) != 1 || first == '%')
+	    continue;
+
+	if (sscanf(line, "%d %d %lf", &src, &dst, &weight) != 3 ||
+	    src < 0 || src >= n_tiles || dst < 0 || dst >= n_tiles || weight < 0.0)
+	{
+	    cerr << "Error: invalid entry '" << line << "' in traffic matrix " << fname << endl;
+	    return false;
+	}
+
+	if (src >= (int) weights.size())
+	    weights.resize(src + 1);
+
+	if (weight > 0.0)
+	    weights[src].push_back(pair < int, double >(dst, weight));
+    }
+
+    // getline stops before the end of the file on a line too long
+    if (!fin.eof())
+    {
+	cerr << "Error: line too long in traffic matrix " << fname << endl;
+	return false;
+    }
+
+    return true;
+}
+
+const vector < pair < int, double > > & TrafficMatrix::getWeights(const int src) const
+{
+    if (src < 0 || src >= (int) weights.size())
+	return no_weights;
+
+    return weights[src];
+}
+
+// A fraction locality of the packets is uniform among the other nodes of
+// the radio hub of src, the rest among the nodes of the other hubs
+static void localWeights(const int src, vector < pair < int, double > > & weights)
+{
+    int n_nodes = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    int n_local = 0;
+
+    for (int i = 0; i < n_nodes; i++)
+	if (i != src && sameRadioHub(src, i))
+	    n_local++;
+
+    int n_remote = n_nodes - 1 - n_local;
+
+    weights.clear();
+    for (int i = 0; i < n_nodes; i++)
+    {
+	if (i == src)
+	    continue;
+
+	if (sameRadioHub(src, i))
+	    weights.push_back(pair < int, double >(i, GlobalParams::locality / max(n_local, 1)));
+	else
+	    weights.push_back(pair < int, double >(i, (1.0 - GlobalParams::locality) / max(n_remote, 1)));
+    }
+}
+
+bool DestinationSampler::shared_built = false;
+AliasTable DestinationSampler::hotspots;
+AliasTable DestinationSampler::ulocal_hops;
+vector < AliasTable > DestinationSampler::ulocal_moves;
+
+void DestinationSampler::configure(const int _src, const TrafficMatrix * matrix)
+{
+    src = _src;
+
+    if (!shared_built)
+    {
+	buildShared(src);
+	shared_built = true;
+    }
+
+    vector < pair < int, double > > weights;
+
+    if (GlobalParams::traffic_distribution == TRAFFIC_LOCAL)
+	localWeights(src, weights);
+    else if (GlobalParams::traffic_distribution == TRAFFIC_MATRIX)
+    {
+	assert(matrix);
+	weights = matrix->getWeights(src);
+    }
+
+    if ((GlobalParams::traffic_distribution == TRAFFIC_LOCAL ||
+	 GlobalParams::traffic_distribution == TRAFFIC_MATRIX) && !table.build(weights))
+	noDestination(src);
+}
+
+// An empty AliasTable cannot be drawn from
+void DestinationSampler::noDestination(const int src)
+{
+    cerr << "Error: no destination of " << src << " has a positive weight with "
+	 << GlobalParams::traffic_distribution << endl;
+    exit(1);
+}
+
+// Random: the hotspots take their slices, the rest is uniform among the
+// nodes but the source. A hotspot does not take its own slice, so that
+// drawing the source from the hotspots gives a uniform destination.
+//
+// Ulocal: random walk from the source of a number of hops decreasing
+// geometrically (one hop with probability 3/4, h > 1 hops with
+// probability 2^-(h+1)). The directions along X and Y are chosen once,
+// and dropped at the borders, each hop is along X or Y with the same
+// probability. So a walk of h hops, k of them along X, ends k nodes
+// away along X, or at the border if nearer, and h - k along Y. Walks
+// longer than the mesh diameter are not taken
+void DestinationSampler::buildShared(const int src)
+{
+    vector < pair < int, double > > weights;
+
+    if (GlobalParams::traffic_distribution == TRAFFIC_RANDOM && !GlobalParams::hotspots.empty())
+    {
+	double range_start = 0.0;
+
+	for (unsigned int i = 0; i < GlobalParams::hotspots.size(); i++)
+	{
+	    double range_end = min(range_start + GlobalParams::hotspots[i].second, 1.0);
+
+	    weights.push_back(pair < int, double >(GlobalParams::hotspots[i].first,
+						    max(range_end - range_start, 0.0)));
+	    range_start = range_end;
+	}
+	weights.push_back(pair < int, double >(NOT_VALID, 1.0 - range_start));
+
+	if (!hotspots.build(weights))
+	    noDestination(src);
+    }
+
+    if (GlobalParams::traffic_distribution == TRAFFIC_ULOCAL)
+    {
+	assert(GlobalParams::topology == TOPOLOGY_MESH);
+
+	int max_hops = GlobalParams::mesh_dim_x + GlobalParams::mesh_dim_y - 2;
+
+	weights.clear();
+	for (int hops = 1; hops <= max_hops; hops++)
+	    weights.push_back(pair < int, double >(hops, (hops == 1) ? 0.75 : ldexp(1.0, -(hops + 1))));
+	if (!ulocal_hops.build(weights))
+	    noDestination(src);
+
+	// binomial, computed in logarithms not to overflow on large meshes
+	ulocal_moves.resize(max_hops + 1);
+	for (int hops = 1; hops <= max_hops; hops++)
+	{
+	    weights.clear();
+	    for (int k = 0; k <= hops; k++)
+		weights.push_back(pair < int, double >(k, exp(lgamma(hops + 1.0) - lgamma(k + 1.0) -
+							      lgamma(hops - k + 1.0) - hops * log(2.0))));
+	    if (!ulocal_moves[hops].build(weights))
+		noDestination(src);
+	}
+    }
+}
+
+int DestinationSampler::sample(RandomGenerator & rng) const
+{
+    if (GlobalParams::traffic_distribution == TRAFFIC_RANDOM)
+	return sampleRandom(rng);
+
+    if (GlobalParams::traffic_distribution == TRAFFIC_ULOCAL)
+	return sampleULocal(rng);
+
+    return table.sample(rng);
+}
+
+int DestinationSampler::sampleRandom(RandomGenerator & rng) const
+{
+    if (!hotspots.empty())
+    {
+	int hotspot = hotspots.sample(rng);
+
+	if (hotspot != NOT_VALID && hotspot != src)
+	    return hotspot;
+    }
+
+    int n_nodes;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+	n_nodes = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    else
+	n_nodes = GlobalParams::n_delta_tiles;
+
+    assert(n_nodes > 1);
+
+    int dst = rng.below(n_nodes - 1);
+
+    return (dst >= src) ? dst + 1 : dst;
+}
+
+int DestinationSampler::sampleULocal(RandomGenerator & rng) const
+{
+    int hops = ulocal_hops.sample(rng);
+    int moves_x = ulocal_moves[hops].sample(rng);
+    int directions = rng.below(4);
+
+    Coord c = id2Coord(src);
+
+    if (directions & 2)
+	c.x += min(moves_x, GlobalParams::mesh_dim_x - 1 - c.x);
+    else
+	c.x -= min(moves_x, c.x);
+
+    if (directions & 1)
+	c.y += min(hops - moves_x, GlobalParams::mesh_dim_y - 1 - c.y);
+    else
+	c.y -= min(hops - moves_x, c.y);
+
+    return coord2Id(c);
+}
+
+bool usesDestinationTable()
+{
+    return (GlobalParams::traffic_distribution == TRAFFIC_RANDOM ||
+	    GlobalParams::traffic_distribution == TRAFFIC_LOCAL ||
+	    GlobalParams::traffic_distribution == TRAFFIC_ULOCAL ||
+	    GlobalParams::traffic_distribution == TRAFFIC_MATRIX);
+}
@@ -0,0 +1,106 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the destination distributions of
+ * the spatial traffic (random, hotspot, local, ulocal and matrix)
+ */
+
+#ifndef __NOXIMDESTINATIONTABLE_H__
+#define __NOXIMDESTINATIONTABLE_H__
+
+#include <vector>
+#include "Random.h"
+
+using namespace std;
+
+// AliasTable -- Walker alias table of a discrete distribution: an outcome
+// is drawn in O(1), whatever the number of outcomes and their weights
+class AliasTable {
+
+  public:
+
+    // Builds the table from the weights of the outcomes, which need not
+    // be normalized. Returns false if no outcome has a positive weight
+    bool build(const vector < pair < int, double > > & weights);
+
+    bool empty() const {
+	return entries.empty();
+    }
+
+    int sample(RandomGenerator & rng) const {
+	const Entry & entry = entries[rng.below(entries.size())];
+
+	return (rng.uniform() < entry.threshold) ? entry.outcome : entry.alias;
+    }
+
+  private:
+
+    // Each entry holds an outcome and the outcome it is completed with
+    struct Entry {
+	double threshold;	// Probability of outcome rather than alias
+	int outcome;
+	int alias;
+    };
+
+    vector < Entry > entries;
+};
+
+// TrafficMatrix -- relative weights of the destinations of each source,
+// read from lines of "source destination weight" ('%' for comments)
+class TrafficMatrix {
+
+  public:
+
+    // Load the matrix from file. Returns true if ok, false otherwise
+    bool load(const char *fname);
+
+    // Weights of the destinations of src, empty if it does not transmit
+    const vector < pair < int, double > > & getWeights(const int src) const;
+
+  private:
+
+    vector < vector < pair < int, double > > > weights;
+    vector < pair < int, double > > no_weights;
+};
+
+// DestinationSampler -- destinations of a source for the traffic
+// distribution in use. The local and matrix distributions are drawn from
+// an AliasTable of the source. The random and ulocal ones are the same for
+// all the sources but for their position, so they are drawn from tables
+// shared by all the sources, whatever the size of the network
+class DestinationSampler {
+
+  public:
+
+    // To be called during the elaboration. The matrix is used by
+    // TRAFFIC_MATRIX only
+    void configure(const int src, const TrafficMatrix * matrix);
+
+    int sample(RandomGenerator & rng) const;
+
+  private:
+
+    int src;
+    AliasTable table;		// Destinations of this source (local, matrix)
+
+    // Shared by all the sources, built by the first one
+    static bool shared_built;
+    static AliasTable hotspots;			// Hotspots, or NOT_VALID for any node
+    static AliasTable ulocal_hops;		// Length of the ulocal walks
+    static vector < AliasTable > ulocal_moves;	// Moves along X among the hops of a walk
+
+    static void buildShared(const int src);
+    static void noDestination(const int src);
+    int sampleRandom(RandomGenerator & rng) const;
+    int sampleULocal(RandomGenerator & rng) const;
+};
+
+// True when the destinations of the traffic distribution in use are drawn
+// from a DestinationSampler
+bool usesDestinationTable();
+
+#endif
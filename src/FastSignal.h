@@ -0,0 +1,138 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the two-phase signal used by
+ * the fast kernel
+ */
+
+#ifndef __NOXIMFASTSIGNAL_H__
+#define __NOXIMFASTSIGNAL_H__
+
+#include <systemc.h>
+#include <vector>
+#include <atomic>
+#include "GlobalParams.h"
+
+using namespace std;
+
+// Raised by the signals a module is sensitive to when their value changes,
+// used by the fast kernel to wake up sleeping modules
+typedef atomic<bool> FastSignalWakeup;
+
+// Signals written during the evaluate phase of the fast kernel are
+// collected here and made visible all together by commitAll(). Each
+// thread has its own list, a signal being written by one module only
+class FastSignalBase
+{
+  public:
+    static void commitAll()
+    {
+	vector<FastSignalBase*> & dirty = dirtySignals();
+
+	for (unsigned int i = 0; i < dirty.size(); i++)
+	    dirty[i]->commit();
+
+	dirty.clear();
+    }
+
+    void addWakeup(FastSignalWakeup * wakeup)
+    {
+	wakeups.push_back(wakeup);
+    }
+
+  protected:
+    FastSignalBase() : dirty(false) {}
+    virtual ~FastSignalBase() {}
+
+    void markDirty()
+    {
+	if (!dirty)
+	{
+	    dirty = true;
+	    dirtySignals().push_back(this);
+	}
+    }
+
+    virtual void commit() = 0;
+
+    void notifyWakeups()
+    {
+	for (unsigned int i = 0; i < wakeups.size(); i++)
+	    wakeups[i]->store(true, memory_order_relaxed);
+    }
+
+    bool dirty;
+    vector<FastSignalWakeup*> wakeups;
+
+  private:
+    static vector<FastSignalBase*> & dirtySignals()
+    {
+	static thread_local vector<FastSignalBase*> signals;
+	return signals;
+    }
+};
+
+// Drop-in replacement of sc_signal. With the fast kernel disabled it
+// behaves exactly as sc_signal, otherwise a write only stores the next
+// value, which is committed by NoC at the end of the clock cycle without
+// going through the SystemC update phase
+template <typename T>
+class FastSignal : public sc_signal<T>, public FastSignalBase
+{
+  public:
+    FastSignal() {}
+    explicit FastSignal(const char * name) : sc_signal<T>(name) {}
+
+    virtual void write(const T & value)
+    {
+	if (!GlobalParams::fast_kernel)
+	{
+	    sc_signal<T>::write(value);
+	    return;
+	}
+
+	// as sc_signal, writing the current value is not a change
+	if (!dirty && value == this->m_cur_val)
+	    return;
+
+	this->m_new_val = value;
+	markDirty();
+    }
+
+    FastSignal<T> & operator=(const T & value)
+    {
+	write(value);
+	return *this;
+    }
+
+  protected:
+    void commit()
+    {
+	if (!(this->m_new_val == this->m_cur_val))
+	{
+	    this->m_cur_val = this->m_new_val;
+	    notifyWakeups();
+	}
+	dirty = false;
+    }
+};
+
+// Makes wakeup be raised whenever the signal bound to port changes.
+// Returns false if port is not bound to a FastSignal
+template <typename PORT>
+bool wakeupOnChange(PORT & port, FastSignalWakeup & wakeup)
+{
+    FastSignalBase * signal = dynamic_cast<FastSignalBase*>(port.operator->());
+
+    if (signal == NULL)
+	return false;
+
+    signal->addWakeup(&wakeup);
+    return true;
+}
+
+#endif
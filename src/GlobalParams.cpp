@@ -35,6 +35,8 @@ double GlobalParams::probability_of_retransmission;
 double GlobalParams::locality;
 string GlobalParams::traffic_distribution;
 string GlobalParams::traffic_table_filename;
+string GlobalParams::traffic_trace_filename;
+string GlobalParams::traffic_matrix_filename;
 string GlobalParams::config_filename;
 string GlobalParams::power_config_filename;
 int GlobalParams::clock_period_ps;
@@ -50,6 +52,7 @@ vector <pair <int, double> > GlobalParams::hotspots;
 bool GlobalParams::show_buffer_stats;
 bool GlobalParams::use_winoc;
 int GlobalParams::winoc_dst_hops;
+bool GlobalParams::winoc_nb_transport;
 bool GlobalParams::use_powermanager;
 ChannelConfig GlobalParams::default_channel_configuration;
 map<int, ChannelConfig> GlobalParams::channel_configuration;
@@ -57,6 +60,15 @@ HubConfig GlobalParams::default_hub_configuration;
 map<int, HubConfig> GlobalParams::hub_configuration;
 map<int, int> GlobalParams::hub_for_tile;
 PowerConfig GlobalParams::power_configuration;
+bool GlobalParams::fast_kernel;
+int GlobalParams::parallel_threads;
+bool GlobalParams::geometric_injection;
+int GlobalParams::route_timeout;
+int GlobalParams::telemetry_interval;
+string GlobalParams::telemetry_filename;
+string GlobalParams::heatmap_filename;
+bool GlobalParams::latency_breakdown;
+string GlobalParams::results_filename;
 // out of yaml configuration
 bool GlobalParams::ascii_monitor;
 int GlobalParams::channel_selection;
@@ -74,6 +74,8 @@ using namespace std;
 #define TRAFFIC_BUTTERFLY      "TRAFFIC_BUTTERFLY"
 #define TRAFFIC_LOCAL	       "TRAFFIC_LOCAL"
 #define TRAFFIC_ULOCAL	       "TRAFFIC_ULOCAL"
+#define TRAFFIC_TRACE	       "TRAFFIC_TRACE"
+#define TRAFFIC_MATRIX	       "TRAFFIC_MATRIX"
 
 // Verbosity levels
 #define VERBOSE_OFF            "VERBOSE_OFF"
@@ -89,6 +91,12 @@ using namespace std;
 #define TOKEN_HOLD             "TOKEN_HOLD"
 #define TOKEN_MAX_HOLD         "TOKEN_MAX_HOLD"
 #define TOKEN_PACKET           "TOKEN_PACKET"
+#define TOKEN_DEMAND           "TOKEN_DEMAND"
+
+// MAC policy of a channel, resolved from the name of the policy
+enum MacPolicy {
+    MAC_TOKEN_PACKET, MAC_TOKEN_HOLD, MAC_TOKEN_MAX_HOLD, MAC_TOKEN_DEMAND
+};
 
 typedef struct {
     pair<double, double> ber;
@@ -160,6 +168,8 @@ struct GlobalParams {
     static double locality;
     static string traffic_distribution;
     static string traffic_table_filename;
+    static string traffic_trace_filename;
+    static string traffic_matrix_filename;
     static string config_filename;
     static string power_config_filename;
     static int clock_period_ps;
@@ -175,6 +185,7 @@ struct GlobalParams {
     static bool show_buffer_stats;
     static bool use_winoc;
     static int winoc_dst_hops;
+    static bool winoc_nb_transport;
     static bool use_powermanager;
     static ChannelConfig default_channel_configuration;
     static map<int, ChannelConfig> channel_configuration;
@@ -182,6 +193,15 @@ struct GlobalParams {
     static map<int, HubConfig> hub_configuration;
     static map<int, int> hub_for_tile;
     static PowerConfig power_configuration;
+    static bool fast_kernel;
+    static int parallel_threads;
+    static bool geometric_injection;
+    static int route_timeout;
+    static int telemetry_interval;
+    static string telemetry_filename;
+    static string heatmap_filename;
+    static bool latency_breakdown;
+    static string results_filename;
     // out of yaml configuration
     static bool ascii_monitor;
     static int channel_selection;
@@ -9,6 +9,10 @@
  */
 
 #include "GlobalRoutingTable.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 using namespace std;
 
 LinkId direction2ILinkId(const int node_id, const int dir)
@@ -64,31 +68,153 @@ int oLinkId2Direction(const LinkId & out_link)
     return 0;
 }
 
-vector <
-    int >admissibleOutputsSet2Vector(const AdmissibleOutputs & ao)
+int iLinkId2Direction(const LinkId & in_link)
 {
-    vector < int >dirs;
+    int src = in_link.first;
+    int dst = in_link.second;
 
-    for (AdmissibleOutputs::iterator i = ao.begin(); i != ao.end();
-	 i++)
-	dirs.push_back(oLinkId2Direction(*i));
+    if (src == dst)
+	return DIRECTION_LOCAL;
+    else if (src == dst + 1)
+	return DIRECTION_EAST;
+    else if (src == dst - 1)
+	return DIRECTION_WEST;
+    else if (src == dst - GlobalParams::mesh_dim_x)
+	return DIRECTION_NORTH;
+    else if (src == dst + GlobalParams::mesh_dim_x)
+	return DIRECTION_SOUTH;
+    else
+	assert(false);
+    return 0;
+}
+
+DirectionSet directionMask2DirectionSet(const unsigned char mask)
+{
+    // NORTH, WEST, LOCAL, EAST and SOUTH lead to increasing node ids
+    static const int order[] = { DIRECTION_NORTH, DIRECTION_WEST, DIRECTION_LOCAL,
+				 DIRECTION_EAST, DIRECTION_SOUTH };
+    DirectionSet dirs;
+
+    for (int i = 0; i < ROUTING_TABLE_INPUTS; i++)
+	if (mask & (1 << order[i]))
+	    dirs.push_back(order[i]);
 
     return dirs;
 }
 
 GlobalRoutingTable::GlobalRoutingTable()
 {
+    mapped = NULL;
+    mapped_size = 0;
+    entries = NULL;
+    n_nodes = 0;
+    valid = false;
+}
+
+GlobalRoutingTable::~GlobalRoutingTable()
+{
+    unload();
+}
+
+void GlobalRoutingTable::unload()
+{
+    if (mapped)
+	munmap(mapped, mapped_size);
+
+    mapped = NULL;
+    mapped_size = 0;
+    text_entries.clear();
+    entries = NULL;
     valid = false;
 }
 
 bool GlobalRoutingTable::load(const char *fname)
+{
+    unload();
+
+    int fd = open(fname, O_RDONLY);
+
+    if (fd < 0)
+	return false;
+
+    struct stat st;
+    char magic[4];
+    bool compiled = (fstat(fd, &st) == 0 &&
+		     read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+		     memcmp(magic, ROUTING_TABLE_MAGIC, sizeof(magic)) == 0);
+    bool ok;
+
+    if (compiled)
+	ok = loadCompiled(fd, st.st_size, fname);
+    else
+	ok = loadText(fname);
+
+    close(fd);
+
+    valid = ok;
+
+    return ok;
+}
+
+bool GlobalRoutingTable::loadCompiled(const int fd, const size_t size, const char *fname)
+{
+    if (size < sizeof(CompiledRoutingTableHeader))
+    {
+	cerr << "Error: truncated routing table " << fname << endl;
+	return false;
+    }
+
+    // the pages are read from the file when first accessed by a router
+    mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapped == MAP_FAILED)
+    {
+	mapped = NULL;
+	cerr << "Error: cannot map routing table " << fname << endl;
+	return false;
+    }
+
+    mapped_size = size;
+
+    const CompiledRoutingTableHeader * header = (const CompiledRoutingTableHeader *) mapped;
+
+    if (header->version != ROUTING_TABLE_VERSION)
+    {
+	cerr << "Error: routing table " << fname << " has version " << header->version
+	     << ", expected " << ROUTING_TABLE_VERSION << " (recompile it with rt2bin)" << endl;
+	return false;
+    }
+
+    if ((int) header->mesh_dim_x != GlobalParams::mesh_dim_x ||
+	(int) header->mesh_dim_y != GlobalParams::mesh_dim_y)
+    {
+	cerr << "Error: routing table " << fname << " is for a " << header->mesh_dim_x
+	     << "x" << header->mesh_dim_y << " mesh" << endl;
+	return false;
+    }
+
+    n_nodes = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+
+    if (size != sizeof(CompiledRoutingTableHeader) + (size_t) n_nodes * ROUTING_TABLE_INPUTS * n_nodes)
+    {
+	cerr << "Error: truncated routing table " << fname << endl;
+	return false;
+    }
+
+    entries = (const unsigned char *) mapped + sizeof(CompiledRoutingTableHeader);
+
+    return true;
+}
+
+bool GlobalRoutingTable::loadText(const char *fname)
 {
     ifstream fin(fname, ios::in);
 
     if (!fin)
 	return false;
 
-    rt_noc.clear();
+    n_nodes = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    text_entries.assign((size_t) n_nodes * ROUTING_TABLE_INPUTS * n_nodes, 0);
 
     bool stop = false;
     while (!fin.eof() && !stop) {
@@ -104,29 +230,29 @@ bool GlobalRoutingTable::load(const char *fname)
 		if (sscanf
 		    (line + 1, "%d %d->%d %d", &node_id, &in_src, &in_dst,
 		     &dst_id) == 4) {
-		    LinkId lin(in_src, in_dst);
+		    if (node_id < 0 || node_id >= n_nodes || dst_id < 0 || dst_id >= n_nodes) {
+			cerr << "Error: invalid node in line '" << line << "' of routing table "
+			     << fname << endl;
+			return false;
+		    }
 
-		    char *pstr = line + COLUMN_AOC;
-		    while (sscanf(pstr, "%d->%d", &out_src, &out_dst) == 2) {
-			LinkId lout(out_src, out_dst);
+		    int in_dir = iLinkId2Direction(LinkId(in_src, in_dst));
+		    unsigned char & mask = text_entries[((size_t) node_id * ROUTING_TABLE_INPUTS + in_dir) * n_nodes + dst_id];
 
-			rt_noc[node_id][lin][dst_id].insert(lout);
+		    char *pstr = line + COLUMN_AOC;
+		    while (pstr && sscanf(pstr, "%d->%d", &out_src, &out_dst) == 2) {
+			mask |= 1 << oLinkId2Direction(LinkId(out_src, out_dst));
 
 			pstr = strstr(pstr, ",");
-			pstr++;
+			if (pstr)
+			    pstr++;
 		    }
 		}
 	    }
 	}
     }
 
-    valid = true;
+    entries = &text_entries[0];
 
     return true;
 }
-
-RoutingTableNode GlobalRoutingTable::
-getNodeRoutingTable(const int node_id)
-{
-    return rt_noc[node_id];
-}
@@ -26,17 +26,23 @@ using namespace std;
 // Pair of source, destination node
 typedef pair < int, int >LinkId;
 
-// Routing table
-typedef set < LinkId > AdmissibleOutputs;
-
-// Map a destination to a set of admissible outputs
-typedef map < int, AdmissibleOutputs > RoutingTableLink;
-
-// Map an input link to its routing table
-typedef map < LinkId, RoutingTableLink > RoutingTableNode;
+// Compiled routing tables (see other/rt2bin.cpp) start with this header,
+// followed by the admissible outputs of each node. Integers are stored
+// in the byte order of the machine which compiled the table
+#define ROUTING_TABLE_MAGIC	"NXRT"
+#define ROUTING_TABLE_VERSION	1
+
+struct CompiledRoutingTableHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int mesh_dim_x;
+    unsigned int mesh_dim_y;
+};
 
-// Map a node of the network to its routing table
-typedef map < int, RoutingTableNode > RoutingTableNoC;
+// The admissible outputs for a node, an input direction and a
+// destination are a bitmask of output directions. Entries are stored for
+// [node][input direction (up to DIRECTION_LOCAL)][destination]
+#define ROUTING_TABLE_INPUTS	(DIRECTION_LOCAL + 1)
 
 // Converts an input direction to a link 
 LinkId direction2ILinkId(const int node_id, const int dir);
@@ -44,26 +50,47 @@ LinkId direction2ILinkId(const int node_id, const int dir);
 // Converts an input direction to a link
 int oLinkId2Direction(const LinkId & out_link);
 
-// Converts a set of output links to a set of directions
-vector <
-    int >admissibleOutputsSet2Vector(const AdmissibleOutputs & ao);
+// Converts an input link to the input direction of its destination node
+int iLinkId2Direction(const LinkId & in_link);
+
+// Converts a bitmask of output directions to a set of directions, in the
+// order of the ids of the nodes they lead to (as in the text tables)
+DirectionSet directionMask2DirectionSet(const unsigned char mask);
 
 class GlobalRoutingTable {
 
   public:
 
     GlobalRoutingTable();
+    ~GlobalRoutingTable();
 
-    // Load routing table from file. Returns true if ok, false otherwise
+    // Load routing table from file, either in text format or compiled by
+    // rt2bin. Returns true if ok, false otherwise
     bool load(const char *fname);
 
-    RoutingTableNode getNodeRoutingTable(const int node_id);
+    // Returns the admissible outputs of node_id, ROUTING_TABLE_INPUTS *
+    // getDestinations() entries
+    const unsigned char * getNodeRoutingTable(const int node_id) const {
+	return entries + (size_t) node_id * ROUTING_TABLE_INPUTS * n_nodes;
+    }
+
+    int getDestinations() const {
+	return n_nodes;
+    }
 
     bool isValid() {
 	return valid;
   } private:
 
-     RoutingTableNoC rt_noc;
+    bool loadText(const char *fname);
+    bool loadCompiled(const int fd, const size_t size, const char *fname);
+    void unload();
+
+    vector < unsigned char > text_entries;	// Entries parsed from a text table
+    void * mapped;			// Compiled table mapped in memory
+    size_t mapped_size;
+    const unsigned char * entries;	// Entries in use, from either of the above
+    int n_nodes;
     bool valid;
 
 };
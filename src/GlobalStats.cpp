@@ -110,6 +110,44 @@ double GlobalStats::getMaxDelay()
     return maxd;
 }
 
+DelayStats GlobalStats::getDelayStats()
+{
+    DelayStats delays;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		noc->t[x][y]->r->stats.collectDelays(delays);
+    }
+    else // other delta topologies
+    {
+	for (int y = 0; y < GlobalParams::n_delta_tiles; y++)
+	    noc->core[y]->r->stats.collectDelays(delays);
+    }
+
+    return delays;
+}
+
+LatencyBreakdown GlobalStats::getLatencyBreakdown()
+{
+    LatencyBreakdown latency;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		noc->t[x][y]->r->stats.collectLatencyBreakdown(latency);
+    }
+    else // other delta topologies
+    {
+	for (int y = 0; y < GlobalParams::n_delta_tiles; y++)
+	    noc->core[y]->r->stats.collectLatencyBreakdown(latency);
+    }
+
+    return latency;
+}
+
 double GlobalStats::getMaxDelay(const int node_id)
 {
     if (GlobalParams::topology == TOPOLOGY_MESH) 
@@ -442,6 +480,16 @@ void GlobalStats::showStats(std::ostream & out, bool detailed)
 		noc->t[x][y]->r->stats.showStats(y * GlobalParams:: mesh_dim_x + x, out, true);
 	out << "];" << endl;
 
+	if (GlobalParams::latency_breakdown)
+	{
+	    out << endl << "latency_breakdown = [" << endl;
+	    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+		for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		    noc->t[x][y]->r->stats.showLatencyBreakdown(y * GlobalParams:: mesh_dim_x + x, out,
+								  y == 0 && x == 0);
+	    out << "];" << endl;
+	}
+
 	// show MaxDelay matrix
 	vector < vector < double > > md_mtx = getMaxDelayMtx();
 
@@ -498,6 +546,22 @@ void GlobalStats::showStats(std::ostream & out, bool detailed)
     out << "% Average wireless utilization: " << getWirelessPackets()/(double)getReceivedPackets() << endl;
     out << "% Global average delay (cycles): " << getAverageDelay() << endl;
     out << "% Max delay (cycles): " << getMaxDelay() << endl;
+
+    DelayStats delays = getDelayStats();
+    out << "% Delay standard deviation (cycles): " << sqrt(delays.getVariance()) << endl;
+    out << "% Delay percentiles p50 p99 p99.9 (cycles): " << delays.getPercentile(0.5)
+	<< " " << delays.getPercentile(0.99) << " " << delays.getPercentile(0.999) << endl;
+
+    if (GlobalParams::latency_breakdown)
+    {
+	LatencyBreakdown latency = getLatencyBreakdown();
+	double n = latency.count;
+
+	out << "% Average hops: " << latency.hops / n << endl;
+	out << "% Latency breakdown queueing transport contention serialization (cycles): "
+	    << latency.queueing / n << " " << latency.transport / n << " "
+	    << latency.contention / n << " " << latency.serialization / n << endl;
+    }
     out << "% Network throughput (flits/cycle): " << getAggregatedThroughput() << endl;
     out << "% Average IP throughput (flits/cycle/IP): " << getThroughput() << endl;
     out << "% Total energy (J): " << getTotalPower() << endl;
@@ -540,7 +604,7 @@ void GlobalStats::showPowerManagerStats(std::ostream & out)
 	out << "\t" << hub_id << "\t" << std::fixed << (double)h->total_ttxoff_cycles/total_cycles << "\t";
 
 	int s = 0;
-	for (map<int,int>::iterator i = h->abtxoff_cycles.begin(); i!=h->abtxoff_cycles.end();i++) s+=i->second;
+	for (unsigned int i = 0; i < h->abtxoff_cycles.size(); i++) s+=h->abtxoff_cycles[i];
 
 	out << (double)s/h->abtxoff_cycles.size()/total_cycles << endl;
     }
@@ -571,18 +635,16 @@ void GlobalStats::showPowerManagerStats(std::ostream & out)
 	out << "\t" << hub_id << "\t" << std::fixed << (double)h->total_sleep_cycles/total_cycles << "\t";
 
 	int s = 0;
-	for (map<int,int>::iterator i = h->buffer_rx_sleep_cycles.begin();
-		i!=h->buffer_rx_sleep_cycles.end();i++)
-	    s+=i->second;
+	for (unsigned int i = 0; i < h->buffer_rx_sleep_cycles.size(); i++)
+	    s+=h->buffer_rx_sleep_cycles[i];
 
 	out << (double)s/h->buffer_rx_sleep_cycles.size()/total_cycles << "\t";
 
 	s = 0;
-	for (map<int,int>::iterator i = h->buffer_to_tile_poweroff_cycles.begin();
-		i!=h->buffer_to_tile_poweroff_cycles.end();i++)
+	for (unsigned int i = 0; i < h->buffer_to_tile_poweroff_cycles.size(); i++)
 	{
-	    double bttoff_fraction = i->second/(double)total_cycles;
-	    s+=i->second;
+	    double bttoff_fraction = h->buffer_to_tile_poweroff_cycles[i]/(double)total_cycles;
+	    s+=h->buffer_to_tile_poweroff_cycles[i];
 	    if (bttoff_fraction<0.25)
 		bttoff_str+=" ";
 	    else if (bttoff_fraction<0.5)
@@ -607,11 +669,9 @@ void GlobalStats::showPowerManagerStats(std::ostream & out)
 
 }
 
-void GlobalStats::showPowerBreakDown(std::ostream & out)
+void GlobalStats::getPowerBreakDown(map<string,double> & power_dynamic,
+				    map<string,double> & power_static)
 {
-    map<string,double> power_dynamic;
-    map<string,double> power_static;
-
     if (GlobalParams::topology == TOPOLOGY_MESH) 
     {
 	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
@@ -645,6 +705,14 @@ void GlobalStats::showPowerBreakDown(std::ostream & out)
 	updatePowerBreakDown(power_static, 
 		h->power.getStaticPowerBreakDown());
     }
+}
+
+void GlobalStats::showPowerBreakDown(std::ostream & out)
+{
+    map<string,double> power_dynamic;
+    map<string,double> power_static;
+
+    getPowerBreakDown(power_dynamic, power_static);
 
     printMap("power_dynamic",power_dynamic,out);
     printMap("power_static",power_static,out);
@@ -680,6 +748,305 @@ void GlobalStats::showBufferStats(std::ostream & out)
 
 }
 
+// Routers as laid out in the heatmaps: a row for each Y coordinate of the
+// mesh, a single row with the cores and then the switches stage by stage
+// for delta topologies
+vector < vector < Router * > > GlobalStats::getRouterGrid()
+{
+    vector < vector < Router * > > grid;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	grid.resize(GlobalParams::mesh_dim_y);
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		grid[y].push_back(noc->t[x][y]->r);
+    }
+    else // other delta topologies
+    {
+	int stg = log2(GlobalParams::n_delta_tiles);
+	int sw = GlobalParams::n_delta_tiles/2;
+
+	grid.resize(1);
+	for (int y = 0; y < GlobalParams::n_delta_tiles; y++)
+	    grid[0].push_back(noc->core[y]->r);
+	for (int x = 0; x < stg; x++)
+	    for (int y = 0; y < sw; y++)
+		grid[0].push_back(noc->t[x][y]->r);
+    }
+
+    return grid;
+}
+
+static void printHeatmap(const string & label, const vector < vector < double > > & mtx, std::ostream & out)
+{
+    out << label << " = [" << endl;
+    for (unsigned int y = 0; y < mtx.size(); y++)
+    {
+	out << "   ";
+	for (unsigned int x = 0; x < mtx[y].size(); x++)
+	    out << setw(10) << mtx[y][x];
+	out << endl;
+    }
+    out << "];" << endl;
+}
+
+void GlobalStats::saveHeatmaps(const string & filename)
+{
+    ofstream out(filename.c_str());
+    if (!out)
+    {
+	cerr << "Error: cannot write heatmap file " << filename << endl;
+	return;
+    }
+
+    const char *ports[DIRECTIONS + 2] = { "north", "east", "south", "west", "local", "hub" };
+    vector < vector < Router * > > grid = getRouterGrid();
+    vector < vector < double > > mtx(grid.size());
+
+    for (unsigned int y = 0; y < grid.size(); y++)
+	mtx[y].resize(grid[y].size());
+
+    int total_cycles = sc_time_stamp().to_double() / GlobalParams::clock_period_ps - GlobalParams::reset_time;
+
+    out << "% Flits, VC busy refusals (one per cycle for each head flit waiting" << endl
+	<< "% for an output VC reserved by another packet) and full buffer cycles" << endl
+	<< "% are counted from the end of the reset, buffer occupancies (flits, all" << endl
+	<< "% the VCs) from the end of the warm-up" << endl;
+    out << "cycles = " << total_cycles << ";" << endl;
+
+    for (unsigned int y = 0; y < grid.size(); y++)
+	for (unsigned int x = 0; x < grid[y].size(); x++)
+	    mtx[y][x] = grid[y][x]->local_id;
+    printHeatmap("router_id", mtx, out);
+
+    for (int d = 0; d < DIRECTIONS + 2; d++)
+    {
+	for (unsigned int y = 0; y < grid.size(); y++)
+	    for (unsigned int x = 0; x < grid[y].size(); x++)
+		mtx[y][x] = grid[y][x]->forwarded_flits[d];
+	printHeatmap(string("forwarded_flits_") + ports[d], mtx, out);
+
+	for (unsigned int y = 0; y < grid.size(); y++)
+	    for (unsigned int x = 0; x < grid[y].size(); x++)
+		mtx[y][x] = grid[y][x]->vc_busy_refusals[d];
+	printHeatmap(string("vc_busy_refusals_") + ports[d], mtx, out);
+
+	for (unsigned int y = 0; y < grid.size(); y++)
+	    for (unsigned int x = 0; x < grid[y].size(); x++)
+		mtx[y][x] = grid[y][x]->full_buffer_cycles[d];
+	printHeatmap(string("full_buffer_cycles_") + ports[d], mtx, out);
+
+	for (unsigned int y = 0; y < grid.size(); y++)
+	    for (unsigned int x = 0; x < grid[y].size(); x++)
+	    {
+		mtx[y][x] = 0.0;
+		for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		    mtx[y][x] += grid[y][x]->buffer[d][vc].getMeanOccupancy();
+	    }
+	printHeatmap(string("buffer_occupancy_") + ports[d], mtx, out);
+    }
+}
+
+// JSON has neither NaN nor infinity (e.g. average delay of no packets)
+static void jsonNumber(std::ostream & out, const double value)
+{
+    if (std::isfinite(value))
+	out << value;
+    else
+	out << "null";
+}
+
+static void jsonString(std::ostream & out, const string & s)
+{
+    out << '"';
+    for (unsigned int i = 0; i < s.size(); i++)
+    {
+	if (s[i] == '"' || s[i] == '\\')
+	    out << '\\';
+	out << s[i];
+    }
+    out << '"';
+}
+
+static void jsonField(std::ostream & out, const char *name, const double value)
+{
+    out << "  \"" << name << "\": ";
+    jsonNumber(out, value);
+    out << ",\n";
+}
+
+static void jsonField(std::ostream & out, const char *name, const string & value)
+{
+    out << "  \"" << name << "\": ";
+    jsonString(out, value);
+    out << ",\n";
+}
+
+template < typename T >
+static void jsonMatrix(std::ostream & out, const char *name, const vector < vector < T > > & mtx)
+{
+    out << "  \"" << name << "\": [";
+    for (unsigned int y = 0; y < mtx.size(); y++)
+    {
+	out << (y ? ",\n    [" : "\n    [");
+	for (unsigned int x = 0; x < mtx[y].size(); x++)
+	{
+	    if (x)
+		out << ", ";
+	    jsonNumber(out, mtx[y][x]);
+	}
+	out << "]";
+    }
+    out << "\n  ],\n";
+}
+
+static void jsonMap(std::ostream & out, const char *name, const map < string, double > & m)
+{
+    out << "  \"" << name << "\": {";
+    for (map < string, double >::const_iterator i = m.begin(); i != m.end(); i++)
+    {
+	out << (i == m.begin() ? "\n    " : ",\n    ");
+	jsonString(out, i->first);
+	out << ": ";
+	jsonNumber(out, i->second);
+    }
+    out << "\n  },\n";
+}
+
+void GlobalStats::saveResults(const string & filename, const double wall_clock_time)
+{
+    ofstream out(filename.c_str());
+    if (!out)
+    {
+	cerr << "Error: cannot write results file " << filename << endl;
+	return;
+    }
+
+    out.precision(10);
+
+    double cycles = sc_time_stamp().to_double() / GlobalParams::clock_period_ps - GlobalParams::reset_time;
+    DelayStats delays = getDelayStats();
+
+    // configuration
+    out << "{\n";
+    jsonField(out, "topology", GlobalParams::topology);
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	jsonField(out, "mesh_dim_x", GlobalParams::mesh_dim_x);
+	jsonField(out, "mesh_dim_y", GlobalParams::mesh_dim_y);
+    }
+    else
+	jsonField(out, "n_delta_tiles", GlobalParams::n_delta_tiles);
+    jsonField(out, "routing_algorithm", GlobalParams::routing_algorithm);
+    jsonField(out, "selection_strategy", GlobalParams::selection_strategy);
+    jsonField(out, "traffic_distribution", GlobalParams::traffic_distribution);
+    jsonField(out, "packet_injection_rate", GlobalParams::packet_injection_rate);
+    jsonField(out, "seed", GlobalParams::rnd_generator_seed);
+
+    // simulation speed
+    jsonField(out, "cycles", cycles);
+    jsonField(out, "wall_clock_time", wall_clock_time);
+    jsonField(out, "cycles_per_second", cycles / wall_clock_time);
+
+    // as shown by showStats
+    jsonField(out, "received_packets", getReceivedPackets());
+    jsonField(out, "received_flits", getReceivedFlits());
+    jsonField(out, "received_ideal_flits_ratio", getReceivedIdealFlitRatio());
+    jsonField(out, "wireless_utilization", getWirelessPackets() / (double) getReceivedPackets());
+    jsonField(out, "average_delay", getAverageDelay());
+    jsonField(out, "max_delay", getMaxDelay());
+    jsonField(out, "delay_standard_deviation", sqrt(delays.getVariance()));
+    jsonField(out, "delay_p50", delays.getPercentile(0.5));
+    jsonField(out, "delay_p99", delays.getPercentile(0.99));
+    jsonField(out, "delay_p999", delays.getPercentile(0.999));
+    jsonField(out, "network_throughput", getAggregatedThroughput());
+    jsonField(out, "ip_throughput", getThroughput());
+    jsonField(out, "total_energy", getTotalPower());
+    jsonField(out, "dynamic_energy", getDynamicPower());
+    jsonField(out, "static_energy", getStaticPower());
+
+    if (GlobalParams::latency_breakdown)
+    {
+	LatencyBreakdown latency = getLatencyBreakdown();
+	double n = latency.count;
+
+	jsonField(out, "average_hops", latency.hops / n);
+	jsonField(out, "latency_queueing", latency.queueing / n);
+	jsonField(out, "latency_transport", latency.transport / n);
+	jsonField(out, "latency_contention", latency.contention / n);
+	jsonField(out, "latency_serialization", latency.serialization / n);
+    }
+
+    map<string,double> power_dynamic;
+    map<string,double> power_static;
+
+    getPowerBreakDown(power_dynamic, power_static);
+    jsonMap(out, "power_dynamic", power_dynamic);
+    jsonMap(out, "power_static", power_static);
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	jsonMatrix(out, "max_delay_matrix", getMaxDelayMtx());
+	jsonMatrix(out, "routed_flits_matrix", getRoutedFlitsMtx());
+    }
+
+    vector < vector < Router * > > grid = getRouterGrid();
+    bool first = true;
+
+    // with detailed, one entry for each communication
+    if (GlobalParams::detailed)
+    {
+	out << "  \"communications\": [";
+	for (unsigned int y = 0; y < grid.size(); y++)
+	    for (unsigned int x = 0; x < grid[y].size(); x++)
+	    {
+		const vector < CommHistory > & chist = grid[y][x]->stats.getCommHistory();
+
+		for (unsigned int i = 0; i < chist.size(); i++)
+		{
+		    out << (first ? "\n    {" : ",\n    {");
+		    out << "\"src\": " << chist[i].src_id << ", \"dst\": " << grid[y][x]->local_id
+			<< ", \"packets\": " << chist[i].delays.count
+			<< ", \"flits\": " << chist[i].total_received_flits << ", \"average_delay\": ";
+		    jsonNumber(out, chist[i].delays.getMean());
+		    out << ", \"max_delay\": " << chist[i].delays.max << "}";
+		    first = false;
+		}
+	    }
+	out << "\n  ],\n";
+    }
+
+    // input buffers of each router, [port][vc]
+    first = true;
+    out << "  \"buffers\": [";
+    for (unsigned int y = 0; y < grid.size(); y++)
+	for (unsigned int x = 0; x < grid[y].size(); x++)
+	{
+	    Router *r = grid[y][x];
+
+	    out << (first ? "\n    {" : ",\n    {") << "\"router\": " << r->local_id << ", \"mean_occupancy\": [";
+	    for (int d = 0; d < DIRECTIONS + 2; d++)
+	    {
+		out << (d ? ", [" : "[");
+		for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		    out << (vc ? ", " : "") << r->buffer[d][vc].getMeanOccupancy();
+		out << "]";
+	    }
+	    out << "], \"max_occupancy\": [";
+	    for (int d = 0; d < DIRECTIONS + 2; d++)
+	    {
+		out << (d ? ", [" : "[");
+		for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		    out << (vc ? ", " : "") << r->buffer[d][vc].getMaxOccupancy();
+		out << "]";
+	    }
+	    out << "]}";
+	    first = false;
+	}
+    out << "\n  ]\n}\n";
+}
+
 double GlobalStats::getReceivedIdealFlitRatio()
 {
     int total_cycles;
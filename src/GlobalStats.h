@@ -14,6 +14,7 @@
 #include <iostream>
 #include <vector>
 #include <iomanip>
+#include <fstream>
 #include "NoC.h"
 #include "Tile.h"
 using namespace std;
@@ -41,6 +42,12 @@ class GlobalStats {
     // Returns the max delay (cycles) for communication src_id->dst_id
     double getMaxDelay(const int src_id, const int dst_id);
 
+    // Returns the delays of all the received packets, merged
+    DelayStats getDelayStats();
+
+    // Returns the latency breakdown of all the received packets, merged
+    LatencyBreakdown getLatencyBreakdown();
+
     // Returns tha matrix of max delay for any node of the network
      vector < vector < double > > getMaxDelayMtx();
 
@@ -83,6 +90,16 @@ class GlobalStats {
 
     void showBufferStats(std::ostream & out);
 
+    // Writes to filename, as matrices laid out like the routers, the
+    // flits forwarded and the cycles blocked on each output port and the
+    // mean occupancy of each input port
+    void saveHeatmaps(const string & filename);
+
+    // Writes to filename, in JSON, the statistics shown by showStats and
+    // the matrices, power breakdown and buffer statistics of the detailed
+    // report. wall_clock_time (seconds) gives the simulation speed
+    void saveResults(const string & filename, const double wall_clock_time);
+
 
     void showPowerBreakDown(std::ostream & out);
 
@@ -99,6 +116,8 @@ class GlobalStats {
   private:
     const NoC *noc;
     void updatePowerBreakDown(map<string,double> &dst,PowerBreakdown* src);
+    void getPowerBreakDown(map<string,double> & power_dynamic, map<string,double> & power_static);
+    vector < vector < Router * > > getRouterGrid();
 };
 
 #endif
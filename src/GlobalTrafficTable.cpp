@@ -9,6 +9,8 @@
  */
 
 #include "GlobalTrafficTable.h"
+#include <algorithm>
+#include <map>
 
 GlobalTrafficTable::GlobalTrafficTable()
 {
@@ -75,13 +77,17 @@ bool GlobalTrafficTable::load(const char *fname)
 	      GlobalParams::simulation_time;
 
 	  // Custom Tperiod
-	  if (params >= 7 && t_period > 0) {
+	  if (params >= 7) {
+	    if (t_period <= 0) {
+	      cerr << "Error: invalid period in line '" << line << "' of traffic table " << fname << endl;
+	      return false;
+	    }
 	    assert(t_period > t_off);
 	    communication.t_period = t_period;
 	  } else
 	    communication.t_period =
-	      GlobalParams::reset_time +
-	      GlobalParams::simulation_time;
+	      max(GlobalParams::reset_time +
+		  GlobalParams::simulation_time, 1);
 
 	  // Add this communication to the vector of communications
 	  traffic_table.push_back(communication);
@@ -90,40 +96,231 @@ bool GlobalTrafficTable::load(const char *fname)
     }
   }
 
+  buildIndex();
+
   return true;
 }
 
-double GlobalTrafficTable::getCumulativePirPor(const int src_id,
-						    const int ccycle,
-						    const bool pir_not_por,
-						    vector < pair < int, double > > &dst_prob)
+static long long gcd(long long a, long long b)
 {
-  double cpirnpor = 0.0;
+  while (b) {
+    long long t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
 
-  dst_prob.clear();
+void GlobalTrafficTable::buildIndex()
+{
+  int n_sources = 0;
 
   for (unsigned int i = 0; i < traffic_table.size(); i++) {
-    Communication comm = traffic_table[i];
-    if (comm.src == src_id) {
-      int r_ccycle = ccycle % comm.t_period;
-      if (r_ccycle > comm.t_on && r_ccycle < comm.t_off) {
-	cpirnpor += pir_not_por ? comm.pir : comm.por;
-	pair < int, double >dp(comm.dst, cpirnpor);
-	dst_prob.push_back(dp);
+    assert(traffic_table[i].src >= 0);
+    n_sources = max(n_sources, traffic_table[i].src + 1);
+  }
+
+  sources.assign(n_sources, SourceActivity());
+
+  for (unsigned int i = 0; i < traffic_table.size(); i++)
+    sources[traffic_table[i].src].communications.push_back(i);
+
+  long long end_time = GlobalParams::reset_time + GlobalParams::simulation_time;
+
+  for (int src = 0; src < n_sources; src++) {
+    SourceActivity & activity = sources[src];
+    const vector < int > & comms = activity.communications;
+
+    activity.window = 0;
+    activity.periodic = false;
+    activity.cached_from = activity.cached_until = 0;
+
+    if (comms.empty())
+      continue;
+
+    // the activity repeats with the least common multiple of the periods
+    long long window = 1;
+
+    for (unsigned int i = 0; i < comms.size() && window < end_time; i++) {
+      long long t_period = traffic_table[comms[i]].t_period;
+      window = window / gcd(window, t_period) * t_period;
+    }
+
+    bool periodic = (window < end_time);
+    window = min(window, end_time);
+
+    // a communication is active for t_on < r_ccycle < t_off: the phases
+    // start at these edges
+    long long n_edges = 0;
+
+    for (unsigned int i = 0; i < comms.size(); i++)
+      n_edges += 2 * ((window - 1) / traffic_table[comms[i]].t_period + 1);
+
+    if (n_edges > TRAFFIC_TABLE_MAX_PHASES)
+      continue;
+
+    vector < int > edges;
+
+    // a window which does not repeat starts with the simulation
+    if (!periodic)
+      edges.push_back(0);
+
+    for (unsigned int i = 0; i < comms.size(); i++) {
+      const Communication & comm = traffic_table[comms[i]];
+
+      for (long long period_start = 0; period_start < window; period_start += comm.t_period) {
+	if (period_start + comm.t_on + 1 < window)
+	  edges.push_back(period_start + comm.t_on + 1);
+	if (period_start + comm.t_off < window)
+	  edges.push_back(period_start + comm.t_off);
+      }
+    }
+
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    activity.window = window;
+    activity.periodic = periodic;
+
+    // periodic communications lead to the same sets over and over
+    map < vector < int >, int > set_ids;
+    vector < int > active;
+
+    for (unsigned int e = 0; e < edges.size(); e++) {
+      activeAt(activity, edges[e], active);
+
+      map < vector < int >, int >::iterator it = set_ids.find(active);
+
+      if (it == set_ids.end()) {
+	it = set_ids.insert(make_pair(active, (int) activity.sets.size())).first;
+	activity.sets.push_back(ActiveCommunications());
+	cumulate(active, activity.sets.back());
       }
+
+      activity.phase_start.push_back(edges[e]);
+      activity.phase_set.push_back(it->second);
+    }
+  }
+}
+
+int GlobalTrafficTable::activeAt(const SourceActivity & activity, const int ccycle,
+				 vector < int > & active) const
+{
+  long long change_cycle = INT_MAX;
+
+  active.clear();
+
+  for (unsigned int i = 0; i < activity.communications.size(); i++) {
+    const Communication & comm = traffic_table[activity.communications[i]];
+    long long r_ccycle = ccycle % comm.t_period;
+    long long period_start = ccycle - r_ccycle;
+
+    if (r_ccycle > comm.t_on && r_ccycle < comm.t_off) {
+      active.push_back(activity.communications[i]);
+      change_cycle = min(change_cycle, period_start + comm.t_off);
+    } else if (r_ccycle <= comm.t_on)
+      change_cycle = min(change_cycle, period_start + comm.t_on + 1);
+    else
+      change_cycle = min(change_cycle, period_start + comm.t_period + comm.t_on + 1);
+  }
+
+  return change_cycle;
+}
+
+void GlobalTrafficTable::cumulate(const vector < int > & active, ActiveCommunications & set) const
+{
+  double cpir = 0.0, cpor = 0.0;
+
+  set.cumulative_pir.clear();
+  set.cumulative_por.clear();
+
+  for (unsigned int i = 0; i < active.size(); i++) {
+    const Communication & comm = traffic_table[active[i]];
+
+    cpir += comm.pir;
+    cpor += comm.por;
+    set.cumulative_pir.push_back(pair < int, double >(comm.dst, cpir));
+    set.cumulative_por.push_back(pair < int, double >(comm.dst, cpor));
+  }
+}
+
+const ActiveCommunications & GlobalTrafficTable::activeCommunications(const int src_id,
+								      const int ccycle,
+								      int & change_cycle) const
+{
+  static const ActiveCommunications none;
+
+  if (src_id < 0 || src_id >= (int) sources.size() || sources[src_id].communications.empty()) {
+    change_cycle = INT_MAX;
+    return none;
+  }
+
+  const SourceActivity & activity = sources[src_id];
+
+  if (activity.window == 0) {
+    if (ccycle < activity.cached_from || ccycle >= activity.cached_until) {
+      vector < int > active;
+
+      activity.cached_from = ccycle;
+      activity.cached_until = activeAt(activity, ccycle, active);
+      cumulate(active, activity.cached);
     }
+
+    change_cycle = activity.cached_until;
+    return activity.cached;
+  }
+
+  if (!activity.periodic && ccycle >= activity.window) {
+    change_cycle = INT_MAX;
+    return none;
   }
 
-  return cpirnpor;
+  const vector < int > & phase_start = activity.phase_start;
+  int r_ccycle = ccycle % activity.window;
+  int window_start = ccycle - r_ccycle;
+  int p = upper_bound(phase_start.begin(), phase_start.end(), r_ccycle) - phase_start.begin() - 1;
+
+  // before the first edge the last phase of the previous window goes on
+  if (p < 0) {
+    p = phase_start.size() - 1;
+    change_cycle = window_start + phase_start[0];
+  } else if (p + 1 < (int) phase_start.size())
+    change_cycle = window_start + phase_start[p + 1];
+  else if (activity.periodic)
+    change_cycle = window_start + activity.window + phase_start[0];
+  else
+    change_cycle = INT_MAX;
+
+  return activity.sets[activity.phase_set[p]];
+}
+
+double GlobalTrafficTable::getCumulativePirPor(const int src_id,
+						    const int ccycle,
+						    const bool pir_not_por,
+						    const vector < pair < int, double > > * & dst_prob) const
+{
+  int change_cycle;
+  const ActiveCommunications & active = activeCommunications(src_id, ccycle, change_cycle);
+
+  dst_prob = pir_not_por ? &active.cumulative_pir : &active.cumulative_por;
+
+  return dst_prob->empty() ? 0.0 : dst_prob->back().second;
 }
 
-int GlobalTrafficTable::occurrencesAsSource(const int src_id)
+int GlobalTrafficTable::getNextActivityChange(const int src_id,
+					      const int ccycle) const
 {
-  int count = 0;
+  int change_cycle;
 
-  for (unsigned int i = 0; i < traffic_table.size(); i++)
-    if (traffic_table[i].src == src_id)
-      count++;
+  activeCommunications(src_id, ccycle, change_cycle);
+
+  return change_cycle;
+}
+
+int GlobalTrafficTable::occurrencesAsSource(const int src_id) const
+{
+  if (src_id < 0 || src_id >= (int) sources.size())
+    return 0;
 
-  return count;
+  return sources[src_id].communications.size();
 }
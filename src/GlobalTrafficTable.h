@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
+#include <climits>
 #include "DataStructs.h"
 
 using namespace std;
@@ -29,6 +30,37 @@ struct Communication {
   int t_period;		        // Period after which activity starts again
 };
 
+// Communications of a source which are active in the same time interval,
+// each paired with the cumulative probability up to it (in table order)
+struct ActiveCommunications {
+  vector < pair < int, double > > cumulative_pir;
+  vector < pair < int, double > > cumulative_por;
+};
+
+// Sources whose activity takes more phases than this per window (see
+// SourceActivity) are evaluated at each phase instead
+#define TRAFFIC_TABLE_MAX_PHASES 1024
+
+// Index of the communications of a source. The activity repeats every
+// window cycles, the least common multiple of their periods (or the end
+// of the simulation if earlier), which is split in phases starting at
+// the cycles in which one of the communications is switched on or off.
+// Sources with too many phases in a window are not indexed: the active
+// communications are computed when a phase begins, and kept until the
+// next one (they are only asked for by the PE of the source)
+struct SourceActivity {
+  vector < int > communications;	// In table order
+  int window;				// 0 if not indexed
+  bool periodic;			// The window repeats (it ends before the simulation otherwise)
+  vector < int > phase_start;		// First cycle of each phase in the window
+  vector < int > phase_set;		// Active communications in each phase
+  vector < ActiveCommunications > sets;	// Distinct sets of active communications
+
+  mutable int cached_from;		// Phase computed for a source not indexed
+  mutable int cached_until;
+  mutable ActiveCommunications cached;
+};
+
 class GlobalTrafficTable {
 
   public:
@@ -40,19 +72,42 @@ class GlobalTrafficTable {
 
     // Returns the cumulative pir por along with a vector of pairs. The
     // first component of the pair is the destination. The second
-    // component is the cumulative shotting probability.
+    // component is the cumulative shotting probability. The vector
+    // belongs to the table
     double getCumulativePirPor(const int src_id,
 			       const int ccycle,
 			       const bool pir_not_por,
-			       vector < pair < int, double > > &dst_prob);
+			       const vector < pair < int, double > > * & dst_prob) const;
+
+    // Returns the first cycle after ccycle in which the set of active
+    // communications of source src_id changes (INT_MAX if never)
+    int getNextActivityChange(const int src_id, const int ccycle) const;
 
     // Returns the number of occurrences of soruce src_id in the traffic
     // table
-    int occurrencesAsSource(const int src_id);
+    int occurrencesAsSource(const int src_id) const;
 
   private:
 
+    // Builds the activity index of every source
+    void buildIndex();
+
+    // Returns the communications of source src_id active at cycle ccycle
+    // and the first cycle after ccycle in which they change
+    const ActiveCommunications & activeCommunications(const int src_id,
+						      const int ccycle,
+						      int & change_cycle) const;
+
+    // Fills active with the communications of the source active at cycle
+    // ccycle, returns the first cycle after it in which one of them is
+    // switched on or off
+    int activeAt(const SourceActivity & activity, const int ccycle,
+		 vector < int > & active) const;
+
+    void cumulate(const vector < int > & active, ActiveCommunications & set) const;
+
      vector < Communication > traffic_table;
+     vector < SourceActivity > sources;		// Indexed by the id of the source
 };
 
 #endif
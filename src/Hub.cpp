@@ -12,30 +12,29 @@
 
 int Hub::tile2Port(int id)
 {
-	// TODO: check all [..] map access to replace with at()
-	return tile2port_mapping.at(id);
+	int port = tile2port_mapping[id];
+
+	assert(port != NOT_VALID && "Specified Tile is not attached to the Hub");
+	return port;
 }
 
-int Hub::route(Flit& f)
+int Hub::route(const Flit & f)
 {
+	const PacketDescriptor & packet = f.packet();
+
 	// check if it is a local delivery
-	for (vector<int>::size_type i=0; i< GlobalParams::hub_configuration[local_id].attachedNodes.size();i++)
-	{
-		// ...to a destination which is connected to the Hub
-		if (GlobalParams::hub_configuration[local_id].attachedNodes[i]==f.dst_id)
-		{
-			return tile2Port(f.dst_id);
-		}
-		// ...or to a relay which is locally connected to the Hub
-		if (GlobalParams::hub_configuration[local_id].attachedNodes[i]==f.hub_relay_node)
-		{
-			assert(GlobalParams::winoc_dst_hops>0);
-			return tile2Port(f.hub_relay_node);
-		}
+	// ...to a destination which is connected to the Hub
+	if (tile2port_mapping[packet.dst_id] != NOT_VALID)
+		return tile2port_mapping[packet.dst_id];
 
+	// ...or to a relay which is locally connected to the Hub
+	if (packet.hub_relay_node != NOT_VALID && tile2port_mapping[packet.hub_relay_node] != NOT_VALID)
+	{
+		assert(GlobalParams::winoc_dst_hops>0);
+		return tile2port_mapping[packet.hub_relay_node];
 	}
-	return DIRECTION_WIRELESS;
 
+	return DIRECTION_WIRELESS;
 }
 
 
@@ -62,14 +61,12 @@ void Hub::rxPowerManager()
 
 	for (unsigned int i=0;i<rxChannels.size();i++)
 	{
-		int ch_id = rxChannels[i];
-
-		if (!target[ch_id]->buffer_rx.IsEmpty())
+		if (!target[i]->buffer_rx.IsEmpty())
 		{
 			power.leakageAntennaBuffer();
 		}
 		else
-			buffer_rx_sleep_cycles[ch_id]++;
+			buffer_rx_sleep_cycles[i]++;
 	}
 
 	// Check wheter accounting antenna RX buffer
@@ -114,7 +111,7 @@ void Hub::txPowerManager()
 	{
 		// check if not empty or reserved
 		if (!init[i]->buffer_tx.IsEmpty() ||
-			tile2antenna_reservation_table.isNotReserved(i) )
+			tile2antenna_reservation_table.isNotReserved(txChannels[i]) )
 		{
 			power.leakageAntennaBuffer();
 			// check the second condition for turning off analog tx
@@ -160,28 +157,38 @@ void Hub::updateTxPower()
 }
 
 
-void Hub::txRadioProcessTokenPacket(int channel)
+int Hub::tokenCyclesLeft(int slot)
+{
+	// the token ring gives the cycle in which the token moves on
+	int now = (int)(sc_time_stamp().to_double()/GlobalParams::clock_period_ps);
+
+	return current_token_expiration[slot]->read() - now;
+}
+
+void Hub::txRadioProcessTokenPacket(int slot)
 {
-    int current_holder = current_token_holder[channel]->read();
-    int current_channel_flag =flag[channel]->read();
+    int channel = txChannels[slot];
+    int current_holder = current_token_holder[slot]->read();
+    int current_channel_flag =flag[slot]->read();
 
 	if ( current_holder == local_id && current_channel_flag !=RELEASE_CHANNEL)
 	{
-		if (!init[channel]->buffer_tx.IsEmpty())
+		if (!init[slot]->buffer_tx.IsEmpty())
 		{
-			Flit flit = init[channel]->buffer_tx.Front();
+			const Flit & flit = init[slot]->buffer_tx.Front();
 
 			// TODO: check whether it would make sense to use transmission_in_progress to
 			// avoid multiple notify()
 			LOG << "*** [Ch"<<channel<<"] Requesting transmission event of flit " << flit << endl;
-			init[channel]->start_request_event.notify();
+			init[slot]->start_request_event.notify();
 		}
 		else
 		{
-			if (!transmission_in_progress.at(channel))
+			if (!transmission_in_progress[slot])
 			{
 				LOG << "*** [Ch"<<channel<<"] Buffer_tx empty and no trasmission in progress, releasing token" << endl;
-				flag[channel]->write(RELEASE_CHANNEL);
+				flag[slot]->write(RELEASE_CHANNEL);
+				token_ring->notifyRelease(channel);
 			}
 			else
 				LOG << "*** [Ch"<<channel<<"] Buffer_tx empty, but trasmission in progress, holding token" << endl;
@@ -189,25 +196,27 @@ void Hub::txRadioProcessTokenPacket(int channel)
 	}
 }
 
-void Hub::txRadioProcessTokenHold(int channel)
+void Hub::txRadioProcessTokenHold(int slot)
 {
-	if (flag[channel]->read()==RELEASE_CHANNEL)
-		flag[channel]->write(HOLD_CHANNEL);
+	int channel = txChannels[slot];
 
-	if (current_token_holder[channel]->read() == local_id)
+	if (flag[slot]->read()==RELEASE_CHANNEL)
+		flag[slot]->write(HOLD_CHANNEL);
+
+	if (current_token_holder[slot]->read() == local_id)
 	{
-		if (!init[channel]->buffer_tx.IsEmpty())
+		if (!init[slot]->buffer_tx.IsEmpty())
 		{
 			//LOG << "Token holder for channel " << channel << " with not empty buffer_tx" << endl;
-			if (current_token_expiration[channel]->read() < flit_transmission_cycles[channel])
+			if (tokenCyclesLeft(slot) < flit_transmission_cycles[slot])
 			{
 				//LOG << "TOKEN_HOLD policy: Not enough token expiration time for sending channel " << channel << endl;
 			}
 			else
 			{
-				flag[channel]->write(HOLD_CHANNEL);
+				flag[slot]->write(HOLD_CHANNEL);
 				LOG << "*** [Ch" << channel << "] Starting transmission event" << endl;
-				init[channel]->start_request_event.notify();
+				init[slot]->start_request_event.notify();
 			}
 		}
 		else
@@ -217,33 +226,37 @@ void Hub::txRadioProcessTokenHold(int channel)
 	}
 }
 
-void Hub::txRadioProcessTokenMaxHold(int channel)
+void Hub::txRadioProcessTokenMaxHold(int slot)
 {
-	if (flag[channel]->read()==RELEASE_CHANNEL)
-		flag[channel]->write(HOLD_CHANNEL);
+	int channel = txChannels[slot];
+
+	if (flag[slot]->read()==RELEASE_CHANNEL)
+		flag[slot]->write(HOLD_CHANNEL);
 
-	if (current_token_holder[channel]->read() == local_id)
+	if (current_token_holder[slot]->read() == local_id)
 	{
-		if (!init[channel]->buffer_tx.IsEmpty())
+		if (!init[slot]->buffer_tx.IsEmpty())
 		{
 			//LOG << "Token holder for channel " << channel << " with not empty buffer_tx" << endl;
 
-			if (current_token_expiration[channel]->read() < flit_transmission_cycles[channel])
+			if (tokenCyclesLeft(slot) < flit_transmission_cycles[slot])
 			{
 				//LOG << "TOKEN_MAX_HOLD: Not enough token expiration time, releasing token for channel " << channel << endl;
-				flag[channel]->write(RELEASE_CHANNEL);
+				flag[slot]->write(RELEASE_CHANNEL);
+				token_ring->notifyRelease(channel);
 			}
 			else
 			{
-				flag[channel]->write(HOLD_CHANNEL);
+				flag[slot]->write(HOLD_CHANNEL);
 				LOG << "Starting transmission on channel " << channel << endl;
-				init[channel]->start_request_event.notify();
+				init[slot]->start_request_event.notify();
 			}
 		}
 		else
 		{
 			//LOG << "TOKEN_MAX_HOLD: Buffer_tx empty, releasing token for channel " << channel << endl;
-			flag[channel]->write(RELEASE_CHANNEL);
+			flag[slot]->write(RELEASE_CHANNEL);
+			token_ring->notifyRelease(channel);
 		}
 	}
 }
@@ -257,6 +270,7 @@ void Hub::antennaToTileProcess()
 			req_tx[i]->write(0);
 			current_level_tx[i] = 0;
 		}
+		rx_rng.seed(GlobalParams::rnd_generator_seed, RANDOM_STREAM_HUB_RX, local_id);
 		return;
 	}
 	// IMPORTANT: do not move from here
@@ -288,7 +302,7 @@ void Hub::antennaToTileProcess()
 
 			if (!buffer_to_tile[i][vc].IsEmpty())
 			{
-				Flit flit = buffer_to_tile[i][vc].Front();
+				const Flit & flit = buffer_to_tile[i][vc].Front();
 
 				LOG << "Flit " << flit << " found on buffer_to_tile[" << i <<"][" << vc << "] " << endl;
 				if (current_level_tx[i] == ack_tx[i].read() &&
@@ -325,9 +339,9 @@ void Hub::antennaToTileProcess()
 	{
 		int channel = rxChannels[i];
 
-		if (!(target[channel]->buffer_rx.IsEmpty()))
+		if (!(target[i]->buffer_rx.IsEmpty()))
 		{
-			Flit received_flit = target[channel]->buffer_rx.Front();
+			const Flit & received_flit = target[i]->buffer_rx.Front();
 			power.antennaBufferFront();
 
 			// Check antenna buffer_rx making appropriate reservations
@@ -335,14 +349,14 @@ void Hub::antennaToTileProcess()
 			{
 				int dst_port;
 
-				if (received_flit.hub_relay_node!=NOT_VALID)
-					dst_port = tile2Port(received_flit.hub_relay_node);
+				if (received_flit.packet().hub_relay_node!=NOT_VALID)
+					dst_port = tile2Port(received_flit.packet().hub_relay_node);
 				else
-                    dst_port = tile2Port(received_flit.dst_id);
+                    dst_port = tile2Port(received_flit.packet().dst_id);
 
 				TReservation r;
 				r.input = channel;
-				r.vc = received_flit.vc_id;
+				r.vc = received_flit.packet().vc_id;
 
 				LOG << " Checking reservation availability of output port " << dst_port << " by channel " << channel << " for flit " << received_flit << endl;
 
@@ -375,24 +389,22 @@ void Hub::antennaToTileProcess()
 	for (unsigned int i = 0; i < rxChannels.size(); i++)
 	{
 		int channel = rxChannels[i];
-		vector<pair<int,int> > reservations = antenna2tile_reservation_table.getReservations(channel);
+		antenna2tile_reservation_table.getReservations(channel, reservations);
 
 		if (reservations.size()!=0)
 		{
-			int rnd_idx = rand()%reservations.size();
+			int rnd_idx = rx_rng.below(reservations.size());
 
 			int port = reservations[rnd_idx].first;
 			int vc = reservations[rnd_idx].second;
 
-			if (!(target[channel]->buffer_rx.IsEmpty()))
+			if (!(target[i]->buffer_rx.IsEmpty()))
 			{
-				Flit received_flit = target[channel]->buffer_rx.Front();
+				const Flit & received_flit = target[i]->buffer_rx.Front();
 				power.antennaBufferFront();
 
 				if ( !buffer_to_tile[port][vc].IsFull() )
 				{
-					target[channel]->buffer_rx.Pop();
-					power.antennaBufferPop();
 					LOG << "*** [Ch" << channel << "] Moving flit  " << received_flit << " from buffer_rx to buffer_to_tile[" << port <<"][" << vc << "]" << endl;
 
 					buffer_to_tile[port][vc].Push(received_flit);
@@ -406,6 +418,10 @@ void Hub::antennaToTileProcess()
 						r.vc = vc;
 						antenna2tile_reservation_table.release(r,port);
 					}
+
+					// received_flit refers to buffer_rx, it is released last
+					target[i]->buffer_rx.Pop();
+					power.antennaBufferPop();
 				}
 				else
 					LOG << "Full buffer_to_tile[" << port <<"][" << vc << "]" << ", cannot store " << received_flit << endl;
@@ -441,8 +457,8 @@ void Hub::tileToAntennaProcess()
 	{
 		for (unsigned int i =0 ;i<txChannels.size();i++)
 		{
-			int channel = txChannels[i];
-			flag[channel]->write(HOLD_CHANNEL);
+			flag[i]->write(HOLD_CHANNEL);
+			token_request[i]->write(false);
 		}
 
 		TBufferFullStatus bfs;
@@ -452,32 +468,22 @@ void Hub::tileToAntennaProcess()
 			buffer_full_status_rx[i].write(bfs);
 			current_level_rx[i] = 0;
 		}
+		tx_rng.seed(GlobalParams::rnd_generator_seed, RANDOM_STREAM_HUB_TX, local_id);
 		return;
 	}
 
 	for (unsigned int i =0 ;i<txChannels.size();i++)
 	{
-		int channel = txChannels[i];
-
-		string macPolicy = token_ring->getPolicy(channel).first;
-
-		if (macPolicy == TOKEN_PACKET)
-			txRadioProcessTokenPacket(channel);
-		else if (macPolicy == TOKEN_HOLD)
-			txRadioProcessTokenHold(channel);
-		else if (macPolicy == TOKEN_MAX_HOLD)
-			txRadioProcessTokenMaxHold(channel);
+		if (mac_policy[i] == MAC_TOKEN_PACKET || mac_policy[i] == MAC_TOKEN_DEMAND)
+			txRadioProcessTokenPacket(i);
+		else if (mac_policy[i] == MAC_TOKEN_HOLD)
+			txRadioProcessTokenHold(i);
 		else
-			assert(false);
+			txRadioProcessTokenMaxHold(i);
 	}
 
 	int last_reserved = NOT_VALID;
 
-	// used to store routing decisions
-	int * r_from_tile[num_ports];
-	for (int i=0;i<num_ports;i++)
-		r_from_tile[i] = new int[GlobalParams::n_virtual_channels];
-
 	// 1st phase: Reservation
 	for (int j = 0; j < num_ports; j++)
 	{
@@ -491,9 +497,9 @@ void Hub::tileToAntennaProcess()
 			{
 				LOG << "Reservation: buffer_from_tile[" << i <<"][" << vc << "] not empty " << endl;
 
-				Flit flit = buffer_from_tile[i][vc].Front();
+				const Flit & flit = buffer_from_tile[i][vc].Front();
 
-				assert(flit.vc_id == vc);
+				assert(flit.packet().vc_id == vc);
 
 				power.bufferFromTileFront();
 				r_from_tile[i][vc] = route(flit);
@@ -507,10 +513,10 @@ void Hub::tileToAntennaProcess()
 					assert(r_from_tile[i][vc]==DIRECTION_WIRELESS);
 					int channel;
 
-					if (flit.hub_relay_node==NOT_VALID)
-						channel = selectChannel(local_id, tile2Hub(flit.dst_id));
+					if (flit.packet().hub_relay_node==NOT_VALID)
+						channel = selectChannel(tile2Hub(flit.packet().dst_id));
 					else
-						channel = selectChannel(local_id, tile2Hub(flit.hub_relay_node));
+						channel = selectChannel(tile2Hub(flit.packet().hub_relay_node));
 
 
 					assert(channel!=NOT_VALID && "hubs are not connected by any channel");
@@ -549,18 +555,18 @@ void Hub::tileToAntennaProcess()
 	// 2nd phase: Forwarding
 	for (int i = 0; i < num_ports; i++)
 	{
-		vector<pair<int,int> > reservations = tile2antenna_reservation_table.getReservations(i);
+		tile2antenna_reservation_table.getReservations(i, reservations);
 
 		if (reservations.size()!=0)
 		{
-			int rnd_idx = rand()%reservations.size();
+			int rnd_idx = tx_rng.below(reservations.size());
 
 			int o = reservations[rnd_idx].first;
 			int vc = reservations[rnd_idx].second;
 
 			if (!buffer_from_tile[i][vc].IsEmpty())
 			{
-				Flit flit = buffer_from_tile[i][vc].Front();
+				const Flit & flit = buffer_from_tile[i][vc].Front();
 				// powerFront already accounted in 1st phase
 
 				assert(r_from_tile[i][vc] == DIRECTION_WIRELESS);
@@ -569,11 +575,11 @@ void Hub::tileToAntennaProcess()
 
 				if (channel != NOT_RESERVED)
 				{
-					if (!(init[channel]->buffer_tx.IsFull()) )
+					Initiator * initiator = init[tx_slot[channel]];
+
+					if (!(initiator->buffer_tx.IsFull()) )
 					{
-						buffer_from_tile[i][vc].Pop();
-						power.bufferFromTilePop();
-						init[channel]->buffer_tx.Push(flit);
+						initiator->buffer_tx.Push(flit);
 						power.antennaBufferPush();
 						if (flit.flit_type == FLIT_TYPE_TAIL)
 						{
@@ -584,6 +590,10 @@ void Hub::tileToAntennaProcess()
 						}
 
 						LOG << "Flit " << flit << " moved from buffer_from_tile["<<i<<"]["<<vc<<"]  to buffer_tx["<<channel<<"] " << endl;
+
+						// flit refers to buffer_from_tile, it is released last
+						buffer_from_tile[i][vc].Pop();
+						power.bufferFromTilePop();
 					}
 					else
 					{
@@ -606,7 +616,7 @@ void Hub::tileToAntennaProcess()
 		if (req_rx[i]->read() == 1 - current_level_rx[i])
 		{
 			Flit received_flit = flit_rx[i]->read();
-			int vc = received_flit.vc_id;
+			int vc = received_flit.packet().vc_id;
 			LOG << "Reading " << received_flit << " from signal flit_rx[" << i << "]" << endl;
 
 			/*
@@ -640,50 +650,59 @@ void Hub::tileToAntennaProcess()
 		buffer_full_status_rx[i].write(bfs);
 	}
 
+	updateTokenRequests();
+
 	// IMPORTANT: do not move from here
 	// The txPowerManager assumes that all flit buffer write have been done
 	updateTxPower();
 }
 
-int Hub::selectChannel(int src_hub, int dst_hub) const
+void Hub::updateTokenRequests()
 {
-	vector<int> & first = GlobalParams::hub_configuration[src_hub].txChannels;
-	vector<int> & second = GlobalParams::hub_configuration[dst_hub].rxChannels;
+	for (unsigned int i = 0; i < txChannels.size(); i++)
+	{
+		if (mac_policy[i] != MAC_TOKEN_DEMAND)
+			continue;
 
-	vector<int> intersection;
+		bool requesting = !init[i]->buffer_tx.IsEmpty();
 
-	for (unsigned int i=0;i<first.size();i++)
-	{
-		for (unsigned int j=0;j<second.size();j++)
-		{
-			if (first[i] ==second[j])
-				intersection.push_back(first[i]);
-		}
+		if (requesting && !token_request[i]->read())
+			token_ring->notifyRequest(txChannels[i]);
+
+		token_request[i]->write(requesting);
 	}
+}
+
+int Hub::selectChannel(int dst_hub)
+{
+	if (dst_hub < 0 || dst_hub >= (int)channels_to_hub.size())
+	    return NOT_VALID;
+
+	const vector<int> & intersection = channels_to_hub[dst_hub];
 
 	if (intersection.size()==0)
 	    return NOT_VALID;
 
 	if (GlobalParams::channel_selection==CHSEL_RANDOM)
-		return intersection[rand()%intersection.size()];
+		return intersection[tx_rng.below(intersection.size())];
 	else
 	if (GlobalParams::channel_selection==CHSEL_FIRST_FREE)
 	{
-		int start_channel = rand()%intersection.size();
+		int start_channel = tx_rng.below(intersection.size());
 		int k;
 
 		for (vector<int>::size_type i=0;i<intersection.size();i++)
 		{
 			k = (start_channel+i)%intersection.size();
 
-			if (!transmission_in_progress.at(intersection[k]))
+			if (!transmission_in_progress[tx_slot[intersection[k]]])
 			{
-				cout << "Found free channel " << intersection[k] << " on (src,dest) (" << src_hub << "," << dst_hub << ") " << endl;
+				cout << "Found free channel " << intersection[k] << " on (src,dest) (" << local_id << "," << dst_hub << ") " << endl;
 				return intersection[k];
 			}
 		}
 		cout << "All channel busy, applying random selection " << endl;
-		return intersection[rand()%intersection.size()];
+		return intersection[tx_rng.below(intersection.size())];
 	}
 
 	return NOT_VALID;
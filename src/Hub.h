@@ -21,6 +21,7 @@
 #include "Target.h"
 #include "TokenRing.h"
 #include "Power.h"
+#include "Random.h"
 
 using namespace std;
 
@@ -36,8 +37,10 @@ SC_MODULE(Hub)
     TokenRing* token_ring;
     int num_ports;
     vector<int> attachedNodes;
-    vector<int> txChannels;
-    vector<int> rxChannels;
+    vector<int> txChannels;	// Channel of each transmitting slot
+    vector<int> rxChannels;	// Channel of each receiving slot
+    vector<int> tx_slot;	// Transmitting slot of each channel, NOT_VALID if none
+    vector<int> rx_slot;	// Receiving slot of each channel, NOT_VALID if none
 
     sc_in<Flit>* flit_rx;
     sc_in<bool>* req_rx;
@@ -55,42 +58,50 @@ SC_MODULE(Hub)
     bool* current_level_tx;	// Current level for ABP
 
 
-    map<int, sc_in<int>* > current_token_holder;
-    map<int, sc_in<int>* > current_token_expiration;
-    map<int, sc_inout<int>* > flag;
-    map<int, bool> transmission_in_progress;
+    // State of the transmitting channels, indexed by slot
+    vector<sc_in<int>* > current_token_holder;
+    vector<sc_in<int>* > current_token_expiration;	// Cycle in which the token moves on
+    vector<sc_inout<int>* > flag;
+    vector<sc_out<bool>* > token_request;	// Flits waiting for the token (TOKEN_DEMAND)
+    vector<bool> transmission_in_progress;
+    vector<MacPolicy> mac_policy;
+    vector<Initiator*> init;
 
-    map<int, Initiator*> init;
-    map<int, Target*> target;
+    vector<Target*> target;	// Receiving channels, indexed by slot
 
-    map<int, int> tile2port_mapping;
-    map<int, int> tile2hub_mapping;
+    vector<int> tile2port_mapping;	// Port of each tile, NOT_VALID if not attached
 
     int start_from_port; // Port from which to start the reservation cycle
     int * start_from_vc; // VC from which to start the reservation cycle for the specific port
+    vector<vector<int> > r_from_tile;	// Routing decisions for buffer_from_tile[port][vc]
 
     ReservationTable antenna2tile_reservation_table;	// Switch reservation table
     ReservationTable tile2antenna_reservation_table;// Wireless reservation table
+    vector<pair<int,int> > reservations;	// Reservations of an input, reused at each cycle
 
     void updateRxPower();
     void updateTxPower();
     void antennaToTileProcess();
     void tileToAntennaProcess();
 
-    int route(Flit&);
+    int route(const Flit &);
     int tile2Port(int);
 
-    void setFlitTransmissionCycles(int cycles,int ch_id) {flit_transmission_cycles[ch_id]=cycles;}
+    void setFlitTransmissionCycles(int cycles,int ch_id) {flit_transmission_cycles[tx_slot[ch_id]]=cycles;}
 
     // Power stats
     Power power;
 
+    // Private random streams of tileToAntennaProcess and antennaToTileProcess
+    RandomGenerator tx_rng;
+    RandomGenerator rx_rng;
+
     int total_sleep_cycles;
     int total_ttxoff_cycles;
-    map<int,int> buffer_rx_sleep_cycles; // antenna buffer RX power off cycles
-    map<int,int> abtxoff_cycles; // antenna buffer TX power off cycles
-    map<int,int> analogtxoff_cycles; // analog TX power off cycles
-    map<int,int> buffer_to_tile_poweroff_cycles;
+    vector<int> buffer_rx_sleep_cycles; // antenna buffer RX power off cycles, by receiving slot
+    vector<int> abtxoff_cycles; // antenna buffer TX power off cycles, by transmitting slot
+    vector<int> analogtxoff_cycles; // analog TX power off cycles, by transmitting slot
+    vector<int> buffer_to_tile_poweroff_cycles; // by port
 
     int wireless_communications_counter;
 
@@ -98,7 +109,7 @@ SC_MODULE(Hub)
 
     Hub(sc_module_name nm, int id, TokenRing * tr): sc_module(nm) {
 
-	if (GlobalParams::use_winoc)
+	if (GlobalParams::use_winoc && !GlobalParams::fast_kernel)
 	{
 	    SC_METHOD(tileToAntennaProcess);
 	    sensitive << reset;
@@ -117,11 +128,43 @@ SC_MODULE(Hub)
         rxChannels = GlobalParams::hub_configuration[local_id].rxChannels;
         txChannels = GlobalParams::hub_configuration[local_id].txChannels;
 
-	antenna2tile_reservation_table.setSize(num_ports);
-	// fix this
-	//tile2antenna_reservation_table.setSize(txChannels.size());
-#define STATIC_MAX_CHANNELS 100
-      tile2antenna_reservation_table.setSize(STATIC_MAX_CHANNELS);
+	// reservations are indexed by radio channel id
+	int n_channels = 0;
+	if (!GlobalParams::channel_configuration.empty())
+	    n_channels = GlobalParams::channel_configuration.rbegin()->first + 1;
+	for (unsigned int i = 0; i < rxChannels.size(); i++)
+	    n_channels = max(n_channels, rxChannels[i] + 1);
+	for (unsigned int i = 0; i < txChannels.size(); i++)
+	    n_channels = max(n_channels, txChannels[i] + 1);
+
+	antenna2tile_reservation_table.setSize(n_channels, num_ports);
+	tile2antenna_reservation_table.setSize(num_ports, n_channels);
+
+	tx_slot.assign(n_channels, NOT_VALID);
+	for (unsigned int i = 0; i < txChannels.size(); i++)
+	    tx_slot[txChannels[i]] = i;
+	rx_slot.assign(n_channels, NOT_VALID);
+	for (unsigned int i = 0; i < rxChannels.size(); i++)
+	    rx_slot[rxChannels[i]] = i;
+
+	// ports are assigned by NoC to the attached tiles
+	int n_tiles;
+	if (GlobalParams::topology == TOPOLOGY_MESH)
+	    n_tiles = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+	else
+	    n_tiles = GlobalParams::n_delta_tiles;
+	tile2port_mapping.assign(n_tiles, NOT_VALID);
+
+	// channels on which this hub can reach each other hub, in the
+	// order of txChannels (see selectChannel)
+	int n_hubs = GlobalParams::hub_configuration.rbegin()->first + 1;
+	channels_to_hub.resize(n_hubs);
+	for (map<int, HubConfig>::iterator it = GlobalParams::hub_configuration.begin();
+	     it != GlobalParams::hub_configuration.end(); ++it)
+	    for (unsigned int i = 0; i < txChannels.size(); i++)
+		for (unsigned int j = 0; j < it->second.rxChannels.size(); j++)
+		    if (txChannels[i] == it->second.rxChannels[j])
+			channels_to_hub[it->first].push_back(txChannels[i]);
 
         flit_rx = new sc_in<Flit>[num_ports];
         req_rx = new sc_in<bool>[num_ports];
@@ -139,11 +182,14 @@ SC_MODULE(Hub)
 	start_from_vc = new int[num_ports];
 
 
-        current_level_rx = new bool[num_ports];
-        current_level_tx = new bool[num_ports];
+        current_level_rx = new bool[num_ports]();
+        current_level_tx = new bool[num_ports]();
 
         start_from_port = 0;
 
+        r_from_tile.assign(num_ports, vector<int>(GlobalParams::n_virtual_channels, NOT_VALID));
+        buffer_to_tile_poweroff_cycles.assign(num_ports, 0);
+
         for(int i = 0; i < num_ports; i++)
         {
             for (int vc = 0;vc<GlobalParams::n_virtual_channels; vc++)
@@ -160,26 +206,32 @@ SC_MODULE(Hub)
             char txt[20];
             int ch = txChannels[i];
             sprintf(txt, "init_%d", ch);
-            init[ch] = new Initiator(txt,this);
-            init[ch]->buffer_tx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].txBufferSize);
-            init[ch]->buffer_tx.setLabel(string(name())+"->abtx["+i_to_string(i)+"]");
-            current_token_holder[ch] = new sc_in<int>();
-            current_token_expiration[ch] = new sc_in<int>();
-            flag[ch] = new sc_inout<int>();
-            token_ring->attachHub(ch,local_id, current_token_holder[ch],current_token_expiration[ch],flag[ch]);
-            transmission_in_progress[ch] = false;
-            // power manager currently assumes TOKEN_PACKET mac policy
+            init.push_back(new Initiator(txt, this, ch, i));
+            init[i]->buffer_tx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].txBufferSize);
+            init[i]->buffer_tx.setLabel(string(name())+"->abtx["+i_to_string(i)+"]");
+            current_token_holder.push_back(new sc_in<int>());
+            current_token_expiration.push_back(new sc_in<int>());
+            flag.push_back(new sc_inout<int>());
+            token_request.push_back(new sc_out<bool>());
+            token_ring->attachHub(ch,local_id, current_token_holder[i],current_token_expiration[i],flag[i],token_request[i]);
+            transmission_in_progress.push_back(false);
+            mac_policy.push_back(token_ring->getMacPolicy(ch));
+            // power manager currently assumes TOKEN_PACKET (or TOKEN_DEMAND) mac policy
             if (GlobalParams::use_powermanager)
-                assert(token_ring->getPolicy(ch).first==TOKEN_PACKET);
+                assert(mac_policy[i] == MAC_TOKEN_PACKET || mac_policy[i] == MAC_TOKEN_DEMAND);
         }
+        flit_transmission_cycles.assign(txChannels.size(), 0);
+        abtxoff_cycles.assign(txChannels.size(), 0);
+        analogtxoff_cycles.assign(txChannels.size(), 0);
 
         for (unsigned int i = 0; i < rxChannels.size(); i++) {
             char txt[20];
             sprintf(txt, "target_%d", rxChannels[i]);
-            target[rxChannels[i]] = new Target(txt, rxChannels[i], this);
-            target[rxChannels[i]]->buffer_rx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].rxBufferSize);
-            target[rxChannels[i]]->buffer_rx.setLabel(string(name())+"->abrx["+i_to_string(i)+"]");
+            target.push_back(new Target(txt, rxChannels[i], this));
+            target[i]->buffer_rx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].rxBufferSize);
+            target[i]->buffer_rx.setLabel(string(name())+"->abrx["+i_to_string(i)+"]");
         }
+        buffer_rx_sleep_cycles.assign(rxChannels.size(), 0);
 
 	start_from_port = 0;
 	total_sleep_cycles = 0;
@@ -191,16 +243,19 @@ SC_MODULE(Hub)
     int getID() { return local_id;}
 
     private:
-    map<int,int> flit_transmission_cycles;
+    vector<int> flit_transmission_cycles;	// By transmitting slot
+    vector<vector<int> > channels_to_hub;	// Transmitting channels received by each hub
 
-    void txRadioProcessTokenPacket(int channel);
-    void txRadioProcessTokenHold(int channel);
-    void txRadioProcessTokenMaxHold(int channel);
+    int tokenCyclesLeft(int slot);
+    void updateTokenRequests();
+    void txRadioProcessTokenPacket(int slot);
+    void txRadioProcessTokenHold(int slot);
+    void txRadioProcessTokenMaxHold(int slot);
 
     void rxPowerManager();
     void txPowerManager();
 
-    int selectChannel(int src, int dst) const ;
+    int selectChannel(int dst_hub);
 };
 
 #endif
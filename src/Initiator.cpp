@@ -10,94 +10,148 @@
 #include "Hub.h"
 #include "Initiator.h"
 
-void Initiator::thread_process()
+// Takes the flit at the front of the TX buffer into a payload of the
+// pool, addressed to its hub (or the relay hub of its packet)
+tlm::tlm_generic_payload* Initiator::prepare_transaction()
 {
+	tlm::tlm_generic_payload* trans = m_mm.allocate();
+	trans->acquire();
 
-	tlm::tlm_generic_payload* trans = new tlm::tlm_generic_payload;
-	tlm::tlm_phase phase;
-	sc_time delay;
+	tlm::tlm_command cmd = tlm::TLM_WRITE_COMMAND;
+	Flit & flit_payload = *reinterpret_cast<Flit*>(trans->get_data_ptr());
+	flit_payload = buffer_tx.Front();
+	hub->power.antennaBufferFront();
 
-	while (1)
+	int destHub;
+
+	// hub relay management  ////////////////////////////////////////////////////////////////
+	// if explicitly set in the header flit, trasmission target should reach a relay hub
+	if (flit_payload.flit_type == FLIT_TYPE_HEAD)
 	{
-		LOG << " *** waiting for transmissions" << endl;
+		if (flit_payload.packet().hub_relay_node!=NOT_VALID) {
+			current_hub_relay = flit_payload.packet().hub_relay_node;
+			LOG << "HUB RELAY: Flit " << flit_payload << " setting transmission hub relay " << current_hub_relay << " to reach destination " << endl;
+		}
+		else
+			current_hub_relay = NOT_VALID;
+	}
+
+	if (current_hub_relay!=NOT_VALID)
+	{
+		flit_payload.packet().hub_relay_node = current_hub_relay;
+		destHub = tile2Hub(flit_payload.packet().hub_relay_node);
+	}
+	else
+	{
+		destHub = tile2Hub(flit_payload.packet().dst_id);
+	}
+	////////////////////////////////////////////////////////////////////////////////
 
-		wait(start_request_event);
 
-		tlm::tlm_command cmd = tlm::TLM_WRITE_COMMAND;
-		flit_payload = buffer_tx.Front();
-		hub->power.antennaBufferFront();
+	LOG << " *** Starting transmission of " << flit_payload << " to reach HUB_" << destHub <<  endl;
 
-		int destHub;
+	trans->set_command(cmd);
+	trans->set_address(static_cast<const uint64>(destHub));
+
+	// data pointer, length and streaming width are set by the pool
+	trans->set_byte_enable_ptr( 0 ); // 0 indicates unused
+	trans->set_dmi_allowed( false ); // Mandatory initial value
+	trans->set_response_status( tlm::TLM_INCOMPLETE_RESPONSE ); // Mandatory initial value
+
+	return trans;
+}
+
+// The flit has reached the target: it leaves the TX buffer, the tail
+// flit gives the token back and the payload goes back to the pool
+void Initiator::complete_transaction(tlm::tlm_generic_payload& trans)
+{
+	const Flit & flit_payload = *reinterpret_cast<Flit*>(trans.get_data_ptr());
+	int destHub = static_cast<int>(trans.get_address());
+
+	hub->power.wirelessTx(hub->local_id,destHub,GlobalParams::flit_size);
+
+	// Initiator obliged to check response status and delay
+	if (!trans.is_response_error() )
+	{
+		buffer_tx.Pop();
+		hub->power.antennaBufferPop();
 
-		// hub relay management  ////////////////////////////////////////////////////////////////
-		// if explicitly set in the header flit, trasmission target should reach a relay hub
 		if (flit_payload.flit_type == FLIT_TYPE_HEAD)
-		{
-			if (flit_payload.hub_relay_node!=NOT_VALID) {
-				current_hub_relay = flit_payload.hub_relay_node;
-				LOG << "HUB RELAY: Flit " << flit_payload << " setting transmission hub relay " << current_hub_relay << " to reach destination " << endl;
-			}
-			else
-				current_hub_relay = NOT_VALID;
-		}
+			hub->transmission_in_progress[_slot] = true;
 
-		if (current_hub_relay!=NOT_VALID)
-		{
-			flit_payload.hub_relay_node = current_hub_relay;
-			destHub = tile2Hub(flit_payload.hub_relay_node);
-		}
-		else
+		if (flit_payload.flit_type == FLIT_TYPE_TAIL)
 		{
-			destHub = tile2Hub(flit_payload.dst_id);
+			LOG << "*** [Ch"<< _channel_id <<"] tail flit sent " << flit_payload << ", releasing token" << endl;
+			hub->flag[_slot]->write(RELEASE_CHANNEL);
+			hub->token_ring->notifyRelease(_channel_id);
+			hub->transmission_in_progress[_slot] = false;
 		}
-		////////////////////////////////////////////////////////////////////////////////
+	}
+	else
+	{
+		LOG << " WARNING: incomplete transaction " << endl;
+	}
+
+	//check_transaction( trans );
 
+	trans.release();
+}
+
+void Initiator::thread_process()
+{
+	sc_time delay;
 
-		LOG << " *** Starting transmission of " << flit_payload << " to reach HUB_" << destHub <<  endl;
+	while (1)
+	{
+		LOG << " *** waiting for transmissions" << endl;
 
-		trans->set_command(cmd);
-		trans->set_address(static_cast<const uint64>(destHub));
+		wait(start_request_event);
 
-		trans->set_data_ptr( reinterpret_cast<unsigned char*>(&flit_payload) );
-		trans->set_data_length( sizeof(Flit) );
-		trans->set_streaming_width( sizeof(Flit) ); // = data_length to indicate no streaming
-		trans->set_byte_enable_ptr( 0 ); // 0 indicates unused
-		trans->set_dmi_allowed( false ); // Mandatory initial value
-		trans->set_response_status( tlm::TLM_INCOMPLETE_RESPONSE ); // Mandatory initial value
+		tlm::tlm_generic_payload* trans = prepare_transaction();
 
 		delay = sc_time(0, SC_PS);
 
 		// Call b_transport to demonstrate the b/nb conversion by the simple_target_socket
 		socket->b_transport( *trans, delay);
 
-		hub->power.wirelessTx(hub->local_id,destHub,GlobalParams::flit_size);
+		complete_transaction(*trans);
+	}
 
-		// Initiator obliged to check response status and delay
-		if (!trans->is_response_error() )
-		{
-			buffer_tx.Pop();
-			hub->power.antennaBufferPop();
-
-			if (flit_payload.flit_type == FLIT_TYPE_HEAD)
-				hub->transmission_in_progress.at(_channel_id) = true;
-
-			if (flit_payload.flit_type == FLIT_TYPE_TAIL)
-			{
-				LOG << "*** [Ch"<< _channel_id <<"] tail flit sent " << flit_payload << ", releasing token" << endl;
-				hub->flag[_channel_id]->write(RELEASE_CHANNEL);
-				hub->transmission_in_progress.at(_channel_id) = false;
-			}
-		}
-		else
-		{
-			LOG << " WARNING: incomplete transaction " << endl;
-		}
+}
 
-		//check_transaction( *trans );
+// Same as thread_process, without a thread: the transmission is started
+// by the hub as before and completed by the channel calling back
+// nb_transport_bw once the flit has been delivered. Requests arriving
+// while a flit is on the air are ignored, as the thread was not waiting
+// for them. The next flit can be started in the very cycle the previous
+// one is delivered, so the flits of a packet are still back to back
+void Initiator::method_process()
+{
+	if (request_in_progress)
+		return;
 
-	}
+	tlm::tlm_generic_payload* trans = prepare_transaction();
+
+	tlm::tlm_phase phase = tlm::BEGIN_REQ;
+	sc_time delay = SC_ZERO_TIME;
+
+	request_in_progress = true;
 
+	// one payload per flit in flight: the previous one is back in the pool
+	assert(m_mm.size() == 1);
+
+	tlm::tlm_sync_enum status = socket->nb_transport_fw(*trans, phase, delay);
+	assert(status == tlm::TLM_ACCEPTED);
 }
 
+tlm::tlm_sync_enum Initiator::nb_transport_bw(tlm::tlm_generic_payload& trans,
+                                              tlm::tlm_phase& phase, sc_time& delay)
+{
+	assert(phase == tlm::BEGIN_RESP);
 
+	request_in_progress = false;
+	complete_transaction(trans);
 
+	phase = tlm::END_RESP;
+	return tlm::TLM_COMPLETED;
+}
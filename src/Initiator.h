@@ -16,6 +16,7 @@
 #include "Utils.h"
 #include "DataStructs.h"
 #include "Buffer.h"
+#include "MM.h"
 
 
 
@@ -38,30 +39,51 @@ struct Initiator: sc_module
 
   //SC_CTOR(Initiator)
   //: socket("socket")  // Construct and name socket
-  Initiator(sc_module_name nm,Hub* h): sc_module(nm),hub(h), socket("socket")
+  Initiator(sc_module_name nm, Hub* h, int channel_id, int slot): sc_module(nm),hub(h), socket("socket")
   {
-
-      int c;
-      if (GlobalParams::use_winoc) SC_THREAD(thread_process);
-      sscanf(nm,"init_%d",&c);
-      _channel_id = c;
+      if (GlobalParams::use_winoc)
+      {
+	  if (GlobalParams::winoc_nb_transport)
+	  {
+	      SC_METHOD(method_process);
+	      sensitive << start_request_event;
+	      dont_initialize();
+	  }
+	  else
+	      SC_THREAD(thread_process);
+      }
+      socket.register_nb_transport_bw(this, &Initiator::nb_transport_bw);
+      _channel_id = channel_id;
+      _slot = slot;
       current_hub_relay = NOT_VALID;
+      request_in_progress = false;
   }
 
   void thread_process();
+  void method_process();
   void check_transaction(tlm::tlm_generic_payload& trans);
 
+  // TLM-2 non-blocking transport, backward path: the channel returns
+  // BEGIN_RESP when the flit has been delivered to the target
+  virtual tlm::tlm_sync_enum nb_transport_bw(tlm::tlm_generic_payload& trans,
+                                             tlm::tlm_phase& phase, sc_time& delay);
+
   sc_event end_request_event;
 
   // custom
   sc_event start_request_event;
 
   Buffer buffer_tx;
-  Flit flit_payload; 
 
     private: 
   int _channel_id;
+  int _slot;		// Transmitting slot of the channel in the hub
   int current_hub_relay;
+  bool request_in_progress;	// A flit is being transmitted (non-blocking transport)
+  mm m_mm;			// Payloads of the flits in transmission
+
+  tlm::tlm_generic_payload* prepare_transaction();
+  void complete_transaction(tlm::tlm_generic_payload& trans);
 };
 
 #endif
@@ -12,25 +12,15 @@
 
 LocalRoutingTable::LocalRoutingTable()
 {
+    admissible = NULL;
+    n_destinations = 0;
 }
 
 void LocalRoutingTable::configure(GlobalRoutingTable & rtable,
 				       const int _node_id)
 {
-    rt_node = rtable.getNodeRoutingTable(_node_id);
+    // the rows are shared with the global table, which outlives the routers
+    admissible = rtable.getNodeRoutingTable(_node_id);
+    n_destinations = rtable.getDestinations();
     node_id = _node_id;
 }
-
-AdmissibleOutputs LocalRoutingTable::
-getAdmissibleOutputs(const LinkId & in_link, const int destination_id)
-{
-    return rt_node[in_link][destination_id];
-}
-
-AdmissibleOutputs LocalRoutingTable::
-getAdmissibleOutputs(const int in_direction, const int destination_id)
-{
-    LinkId lid = direction2ILinkId(node_id, in_direction);
-
-    return getAdmissibleOutputs(lid, destination_id);
-}
@@ -25,20 +25,20 @@ class LocalRoutingTable {
     // routing table rtable
     void configure(GlobalRoutingTable & rtable, const int _node_id);
 
-    // Returns the set of admissible output channels for destination
-    // destination_id and input channel in_link
-    AdmissibleOutputs getAdmissibleOutputs(const LinkId &
-						in_link,
-						const int destination_id);
-
-    // Returns the set of admissible output channels for a destination
+    // Returns the admissible output directions for a destination
     // destination_id and a given input direction
-    AdmissibleOutputs getAdmissibleOutputs(const int in_direction,
-						const int destination_id);
+    DirectionSet getAdmissibleDirections(const int in_direction,
+					 const int destination_id) const {
+	assert(in_direction >= 0 && in_direction < ROUTING_TABLE_INPUTS);
+	assert(destination_id >= 0 && destination_id < n_destinations);
+
+	return directionMask2DirectionSet(admissible[in_direction * n_destinations + destination_id]);
+    }
 
   private:
 
-     RoutingTableNode rt_node;
+    const unsigned char * admissible;	// Rows of the node in the global routing table
+    int n_destinations;
     int node_id;
 };
 
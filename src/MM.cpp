@@ -12,30 +12,34 @@
 mm::gp_t* mm::allocate()
 {
   gp_t* ptr;
-  if (free_list)
+  if (!free_list.empty())
   {
-    ptr = free_list->trans;
-    empties = free_list;
-    free_list = free_list->next;
+    ptr = free_list.back();
+    free_list.pop_back();
   }
   else
   {
     ptr = new gp_t(this);
+    ptr->set_data_ptr( reinterpret_cast<unsigned char*>(new Flit) );
+    ptr->set_data_length( sizeof(Flit) );
+    ptr->set_streaming_width( sizeof(Flit) ); // = data_length to indicate no streaming
+    payloads.push_back(ptr);
   }
   return ptr;
 }
 
 void mm::free(gp_t* trans)
 {
-  if (!empties)
+  // drop the extensions, the data of the payload is kept for reuse
+  trans->reset();
+  free_list.push_back(trans);
+}
+
+mm::~mm()
+{
+  for (unsigned int i = 0; i < payloads.size(); i++)
   {
-    empties = new access;
-    empties->next = free_list;
-    empties->prev = 0;
-    if (free_list)
-      free_list->prev = empties;
+    delete reinterpret_cast<Flit*>(payloads[i]->get_data_ptr());
+    delete payloads[i];
   }
-  free_list = empties;
-  free_list->trans = trans;
-  empties = free_list->prev;
 }
@@ -12,27 +12,30 @@
 #define __MM_H__
 
 #include <tlm>
-
+#include <vector>
+#include "DataStructs.h"
+
+// Pool of the payloads of the wireless transactions. Each payload
+// carries its own flit as data and goes back to the pool when its
+// reference count drops to zero. An initiator has one flit on the air at
+// a time, so its pool holds one payload per flit in flight; payloads and
+// flits are only deleted with it
 class mm: public tlm::tlm_mm_interface
 {
   typedef tlm::tlm_generic_payload gp_t;
 
 public:
-  mm() : free_list(0), empties(0) {}
+  ~mm();
 
   gp_t* allocate();
   void  free(gp_t* trans);
 
+  // Payloads allocated so far
+  unsigned int size() const { return payloads.size(); }
+
 private:
-  struct access
-  {
-    gp_t* trans;
-    access* next;
-    access* prev;
-  };
-
-  access* free_list;
-  access* empties;
+  std::vector<gp_t*> payloads;
+  std::vector<gp_t*> free_list;
 
 };
 
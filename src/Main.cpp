@@ -11,10 +11,12 @@
 #include "ConfigurationManager.h"
 #include "NoC.h"
 #include "GlobalStats.h"
+#include "Telemetry.h"
 #include "DataStructs.h"
 #include "GlobalParams.h"
 
 #include <csignal>
+#include <chrono>
 
 using namespace std;
 
@@ -62,6 +64,10 @@ int sc_main(int arg_num, char *arg_vet[])
     n->clock(clock);
     n->reset(reset);
 
+    // Periodic telemetry, written while running
+    if (GlobalParams::telemetry_interval > 0)
+	new Telemetry("Telemetry", n);
+
     // Trace signals
     sc_trace_file *tf = NULL;
     if (GlobalParams::trace_mode) {
@@ -94,15 +100,16 @@ int sc_main(int arg_num, char *arg_vet[])
 	}
     }
     // Reset the chip and run the simulation
+    chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
     reset.write(1);
     cout << "Reset for " << (int)(GlobalParams::reset_time) << " cycles... ";
-    srand(GlobalParams::rnd_generator_seed);
     sc_start(GlobalParams::reset_time, SC_NS);
 
     reset.write(0);
     cout << " done! " << endl;
     cout << " Now running for " << GlobalParams:: simulation_time << " cycles..." << endl;
     sc_start(GlobalParams::simulation_time, SC_NS);
+    chrono::duration < double > wall_clock_time = chrono::steady_clock::now() - start_time;
 
 
     // Close the simulation
@@ -112,9 +119,16 @@ int sc_main(int arg_num, char *arg_vet[])
     cout << endl;
 //assert(false);
     // Show statistics
+    if (GlobalParams::fast_kernel)
+	n->accountSleepingRouters();
     GlobalStats gs(n);
     gs.showStats(std::cout, GlobalParams::detailed);
 
+    if (!GlobalParams::heatmap_filename.empty())
+	gs.saveHeatmaps(GlobalParams::heatmap_filename);
+
+    if (!GlobalParams::results_filename.empty())
+	gs.saveResults(GlobalParams::results_filename, wall_clock_time.count());
 
     if ((GlobalParams::max_volume_to_be_drained > 0) &&
 	(sc_time_stamp().to_double() / GlobalParams::clock_period_ps - GlobalParams::reset_time >=
@@ -137,5 +151,8 @@ int sc_main(int arg_num, char *arg_vet[])
 #ifdef DEADLOCK_AVOIDANCE
 	cout << "***** WARNING: DEADLOCK_AVOIDANCE ENABLED!" << endl;
 #endif
+
+    n->stopParallelKernel();
+
     return 0;
 }
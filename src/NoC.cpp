@@ -62,24 +62,20 @@ void NoC::buildCommon()
 		//LOG<<"it1 first "<< it1->first<< "second"<< it1->second<<endl;
 
 		// Determine, from configuration file, which Hub is connected to which Channel
-		for(vector<int>::iterator iit = hub_config.txChannels.begin();
-			iit != hub_config.txChannels.end();
-			++iit)
+		for (unsigned int slot = 0; slot < hub_config.txChannels.size(); slot++)
 		{
-			int channel_id = *iit;
+			int channel_id = hub_config.txChannels[slot];
 			//LOG << "Binding " << hub[hub_id]->name() << " to txChannel " << channel_id << endl;
-			hub[hub_id]->init[channel_id]->socket.bind(channel[channel_id]->targ_socket);
+			hub[hub_id]->init[slot]->socket.bind(channel[channel_id]->targ_socket);
 			//LOG << "Binding " << hub[hub_id]->name() << " to txChannel " << channel_id << endl;
 			hub[hub_id]->setFlitTransmissionCycles(channel[channel_id]->getFlitTransmissionCycles(),channel_id);
 		}
 
-		for(vector<int>::iterator iit = hub_config.rxChannels.begin();
-			iit != hub_config.rxChannels.end();
-			++iit)
+		for (unsigned int slot = 0; slot < hub_config.rxChannels.size(); slot++)
 		{
-			int channel_id = *iit;
+			int channel_id = hub_config.rxChannels[slot];
 			//LOG << "Binding " << hub[hub_id]->name() << " to rxChannel " << channel_id << endl;
-			channel[channel_id]->init_socket.bind(hub[hub_id]->target[channel_id]->socket);
+			channel[channel_id]->init_socket.bind(hub[hub_id]->target[slot]->socket);
 			channel[channel_id]->addHub(hub[hub_id]);
 		}
 
@@ -120,6 +116,22 @@ void NoC::buildCommon()
 	if (GlobalParams::traffic_distribution == TRAFFIC_TABLE_BASED)
 		assert(gttable.load(GlobalParams::traffic_table_filename.c_str()));
 
+	// Check for traffic trace availability
+	if (GlobalParams::traffic_distribution == TRAFFIC_TRACE &&
+	    !traffic_trace.load(GlobalParams::traffic_trace_filename.c_str()))
+	{
+		cerr << "Error: cannot load traffic trace " << GlobalParams::traffic_trace_filename << endl;
+		exit(1);
+	}
+
+	// Check for traffic matrix availability
+	if (GlobalParams::traffic_distribution == TRAFFIC_MATRIX &&
+	    !gtmatrix.load(GlobalParams::traffic_matrix_filename.c_str()))
+	{
+		cerr << "Error: cannot load traffic matrix " << GlobalParams::traffic_matrix_filename << endl;
+		exit(1);
+	}
+
 	// Var to track Hub connected ports
 	hub_connected_ports = (int *) calloc(GlobalParams::hub_configuration.size(), sizeof(int));
 
@@ -186,6 +198,7 @@ void NoC::buildButterfly()
 			int tile_id = coord2Id(tile_coord);
 			sprintf(tile_name, "Switch[%d][%d]_(#%d)", i, j, tile_id);//cout<<"tile_name=" <<tile_name<< " i=" <<i << " j=" << j<< " tile_id "<< tile_id<< endl;
 			t[i][j] = new Tile(tile_name, tile_id);
+			tiles.push_back(t[i][j]);
 
 			//cout << "switch  " << i <<  " " << j << "   has an Id = " << tile_id <<  endl;
 			// Tell to the router its coordinates
@@ -254,11 +267,11 @@ void NoC::buildButterfly()
 	//---- Switching bloc connection ---- sw2sw mapping ---
 
 	// declaration of dummy signals used for the useless Tx and Rx connection in Butterfly
-	sc_signal<bool> *bool_dummy_signal= new sc_signal<bool>;
-	sc_signal<int> *int_dummy_signal= new sc_signal<int>;
-	sc_signal<Flit> *flit_dummy_signal= new sc_signal<Flit>;
-	sc_signal<NoP_data> *nop_data_dummy_signal = new sc_signal<NoP_data>;
-	sc_signal<TBufferFullStatus> *tbufferfullstatus_dummy_signal = new sc_signal<TBufferFullStatus>;
+	FastSignal<bool> *bool_dummy_signal= new FastSignal<bool>;
+	FastSignal<int> *int_dummy_signal= new FastSignal<int>;
+	FastSignal<Flit> *flit_dummy_signal= new FastSignal<Flit>;
+	FastSignal<NoP_data> *nop_data_dummy_signal = new FastSignal<NoP_data>;
+	FastSignal<TBufferFullStatus> *tbufferfullstatus_dummy_signal = new FastSignal<TBufferFullStatus>;
 
 	for (int i = 1; i < stg ; i++) 		//stg
 	{
@@ -491,17 +504,17 @@ void NoC::buildButterfly()
 	core = new Tile*[n];
 
 	//signals instantiation for connecting Core2Hub (just to test wioreless in Butterfly)
-	flit_from_hub = new sc_signal<Flit>[n];
-	flit_to_hub = new sc_signal<Flit>[n];
+	flit_from_hub = new FastSignal<Flit>[n];
+	flit_to_hub = new FastSignal<Flit>[n];
 
-	req_from_hub = new sc_signal<bool>[n];
-	req_to_hub = new sc_signal<bool>[n];
+	req_from_hub = new FastSignal<bool>[n];
+	req_to_hub = new FastSignal<bool>[n];
 
-	ack_from_hub = new sc_signal<bool>[n];
-	ack_to_hub = new sc_signal<bool>[n];
+	ack_from_hub = new FastSignal<bool>[n];
+	ack_to_hub = new FastSignal<bool>[n];
 
-	buffer_full_status_from_hub = new sc_signal<TBufferFullStatus>[n];
-	buffer_full_status_to_hub = new sc_signal<TBufferFullStatus>[n];
+	buffer_full_status_from_hub = new FastSignal<TBufferFullStatus>[n];
+	buffer_full_status_to_hub = new FastSignal<TBufferFullStatus>[n];
 
 
 	// Create the Core bloc
@@ -514,6 +527,7 @@ void NoC::buildButterfly()
 
 		sprintf(core_name, "Core_(#%d)",core_id); //cout<< "core_id = "<< core_id << endl;
 		core[i] = new Tile(core_name, core_id);
+		tiles.push_back(core[i]);
 
 		// Tell to the Core router its coordinates
 		core[i]->r->configure( core_id,
@@ -536,6 +550,16 @@ void NoC::buildButterfly()
 			core[i]->pe->traffic_table = &gttable;	// Needed to choose destination
 			core[i]->pe->never_transmit = (gttable.occurrencesAsSource(core[i]->pe->local_id) == 0);
 		}
+		else if (GlobalParams::traffic_distribution == TRAFFIC_TRACE)
+		{
+			core[i]->pe->traffic_trace = &traffic_trace;	// Needed to replay the packets
+			core[i]->pe->never_transmit = (traffic_trace.packetsOfSource(core[i]->pe->local_id) == 0);
+		}
+		else if (GlobalParams::traffic_distribution == TRAFFIC_MATRIX)
+		{
+			core[i]->pe->traffic_matrix = &gtmatrix;	// Needed to choose destination
+			core[i]->pe->never_transmit = gtmatrix.getWeights(core[i]->pe->local_id).empty();
+		}
 		else
 			core[i]->pe->never_transmit = false;
 
@@ -836,6 +860,7 @@ void NoC::buildBaseline()
 	    int tile_id = coord2Id(tile_coord); 
 	    sprintf(tile_name, "Switch[%d][%d]_(#%d)", i, j, tile_id);
 	    t[i][j] = new Tile(tile_name, tile_id);
+	    tiles.push_back(t[i][j]);
 
 	    // Tell to the router its coordinates
 	    t[i][j]->r->configure(tile_id,
@@ -904,11 +929,11 @@ void NoC::buildBaseline()
     //---- Switching bloc connection ---- sw2sw mapping ---
 
     // declaration of dummy signals used for the useless Tx and Rx connection in Butterfly 
-    sc_signal<bool> *bool_dummy_signal= new sc_signal<bool>;
-    sc_signal<int> *int_dummy_signal= new sc_signal<int>;
-    sc_signal<Flit> *flit_dummy_signal= new sc_signal<Flit>;
-    sc_signal<NoP_data> *nop_data_dummy_signal = new sc_signal<NoP_data>;
-    sc_signal<TBufferFullStatus> *tbufferfullstatus_dummy_signal = new sc_signal<TBufferFullStatus>;
+    FastSignal<bool> *bool_dummy_signal= new FastSignal<bool>;
+    FastSignal<int> *int_dummy_signal= new FastSignal<int>;
+    FastSignal<Flit> *flit_dummy_signal= new FastSignal<Flit>;
+    FastSignal<NoP_data> *nop_data_dummy_signal = new FastSignal<NoP_data>;
+    FastSignal<TBufferFullStatus> *tbufferfullstatus_dummy_signal = new FastSignal<TBufferFullStatus>;
 
     //NOTE: the only difference between Baseline and Butterfly mapping architecture is the first stage connections
     //First Stage Mapping(Stage 1)
@@ -1255,17 +1280,17 @@ void NoC::buildBaseline()
     core = new Tile*[n];
 
     //signals instantiation for connecting Core2Hub (NEW feauture on Baseline)
-	flit_from_hub = new sc_signal<Flit>[n];
-	flit_to_hub = new sc_signal<Flit>[n];
+	flit_from_hub = new FastSignal<Flit>[n];
+	flit_to_hub = new FastSignal<Flit>[n];
 
-	req_from_hub = new sc_signal<bool>[n];
-	req_to_hub = new sc_signal<bool>[n];
+	req_from_hub = new FastSignal<bool>[n];
+	req_to_hub = new FastSignal<bool>[n];
 
-	ack_from_hub = new sc_signal<bool>[n];
-	ack_to_hub = new sc_signal<bool>[n];
+	ack_from_hub = new FastSignal<bool>[n];
+	ack_to_hub = new FastSignal<bool>[n];
 
-	buffer_full_status_from_hub = new sc_signal<TBufferFullStatus>[n];
-	buffer_full_status_to_hub = new sc_signal<TBufferFullStatus>[n];
+	buffer_full_status_from_hub = new FastSignal<TBufferFullStatus>[n];
+	buffer_full_status_to_hub = new FastSignal<TBufferFullStatus>[n];
 
 
     // Create the Core bloc 
@@ -1277,6 +1302,7 @@ void NoC::buildBaseline()
 
 	sprintf(core_name, "Core_(#%d)",core_id); //cout<< "core_id = "<< core_id << endl;
 	core[i] = new Tile(core_name, core_id);
+	tiles.push_back(core[i]);
 
 	// Tell to the Core router its coordinates
 	core[i]->r->configure( core_id,
@@ -1299,6 +1325,16 @@ void NoC::buildBaseline()
 	    core[i]->pe->traffic_table = &gttable;	// Needed to choose destination
 	    core[i]->pe->never_transmit = (gttable.occurrencesAsSource(core[i]->pe->local_id) == 0);
 	}
+	else if (GlobalParams::traffic_distribution == TRAFFIC_TRACE)
+	{
+	    core[i]->pe->traffic_trace = &traffic_trace;	// Needed to replay the packets
+	    core[i]->pe->never_transmit = (traffic_trace.packetsOfSource(core[i]->pe->local_id) == 0);
+	}
+	else if (GlobalParams::traffic_distribution == TRAFFIC_MATRIX)
+	{
+	    core[i]->pe->traffic_matrix = &gtmatrix;	// Needed to choose destination
+	    core[i]->pe->never_transmit = gtmatrix.getWeights(core[i]->pe->local_id).empty();
+	}
 	else
 	    core[i]->pe->never_transmit = false;
 
@@ -1567,6 +1603,7 @@ void NoC::buildOmega()
 			int tile_id = coord2Id(tile_coord);
 			sprintf(tile_name, "Switch[%d][%d]_(#%d)", i, j, tile_id);//cout<<"tile_name=" <<tile_name<< " i=" <<i << " j=" << j<< " tile_id "<< tile_id<< endl;
 			t[i][j] = new Tile(tile_name, tile_id);
+			tiles.push_back(t[i][j]);
 
 			//cout << "switch  " << i <<  " " << j << "   has an Id = " << tile_id <<  endl;
 			// Tell to the router its coordinates
@@ -1634,11 +1671,11 @@ void NoC::buildOmega()
 	//---- Switching bloc connection ---- sw2sw mapping ---
 
 	// declaration of dummy signals used for the useless Tx and Rx connection in Butterfly
-	sc_signal<bool> *bool_dummy_signal= new sc_signal<bool>;
-	sc_signal<int> *int_dummy_signal= new sc_signal<int>;
-	sc_signal<Flit> *flit_dummy_signal= new sc_signal<Flit>;
-	sc_signal<NoP_data> *nop_data_dummy_signal = new sc_signal<NoP_data>;
-	sc_signal<TBufferFullStatus> *tbufferfullstatus_dummy_signal = new sc_signal<TBufferFullStatus>;
+	FastSignal<bool> *bool_dummy_signal= new FastSignal<bool>;
+	FastSignal<int> *int_dummy_signal= new FastSignal<int>;
+	FastSignal<Flit> *flit_dummy_signal= new FastSignal<Flit>;
+	FastSignal<NoP_data> *nop_data_dummy_signal = new FastSignal<NoP_data>;
+	FastSignal<TBufferFullStatus> *tbufferfullstatus_dummy_signal = new FastSignal<TBufferFullStatus>;
 
 
 	int n = GlobalParams::n_delta_tiles;
@@ -1884,17 +1921,17 @@ void NoC::buildOmega()
 	core = new Tile*[n];
 
 	//signals instantiation for connecting Core2Hub (NEW feature in Omega)
-	flit_from_hub = new sc_signal<Flit>[n];
-	flit_to_hub = new sc_signal<Flit>[n];
+	flit_from_hub = new FastSignal<Flit>[n];
+	flit_to_hub = new FastSignal<Flit>[n];
 
-	req_from_hub = new sc_signal<bool>[n];
-	req_to_hub = new sc_signal<bool>[n];
+	req_from_hub = new FastSignal<bool>[n];
+	req_to_hub = new FastSignal<bool>[n];
 
-	ack_from_hub = new sc_signal<bool>[n];
-	ack_to_hub = new sc_signal<bool>[n];
+	ack_from_hub = new FastSignal<bool>[n];
+	ack_to_hub = new FastSignal<bool>[n];
 
-	buffer_full_status_from_hub = new sc_signal<TBufferFullStatus>[n];
-	buffer_full_status_to_hub = new sc_signal<TBufferFullStatus>[n];
+	buffer_full_status_from_hub = new FastSignal<TBufferFullStatus>[n];
+	buffer_full_status_to_hub = new FastSignal<TBufferFullStatus>[n];
 
 
 	// Create the Core bloc
@@ -1907,6 +1944,7 @@ void NoC::buildOmega()
 
 		sprintf(core_name, "Core_(#%d)",core_id); //cout<< "core_id = "<< core_id << endl;
 		core[i] = new Tile(core_name, core_id);
+		tiles.push_back(core[i]);
 
 		// Tell to the Core router its coordinates
 		core[i]->r->configure( core_id,
@@ -1929,6 +1967,16 @@ void NoC::buildOmega()
 			core[i]->pe->traffic_table = &gttable;	// Needed to choose destination
 			core[i]->pe->never_transmit = (gttable.occurrencesAsSource(core[i]->pe->local_id) == 0);
 		}
+		else if (GlobalParams::traffic_distribution == TRAFFIC_TRACE)
+		{
+			core[i]->pe->traffic_trace = &traffic_trace;	// Needed to replay the packets
+			core[i]->pe->never_transmit = (traffic_trace.packetsOfSource(core[i]->pe->local_id) == 0);
+		}
+		else if (GlobalParams::traffic_distribution == TRAFFIC_MATRIX)
+		{
+			core[i]->pe->traffic_matrix = &gtmatrix;	// Needed to choose destination
+			core[i]->pe->never_transmit = gtmatrix.getWeights(core[i]->pe->local_id).empty();
+		}
 		else
 			core[i]->pe->never_transmit = false;
 
@@ -2184,6 +2232,7 @@ void NoC::buildMesh()
 	    int tile_id = coord2Id(tile_coord);
 	    sprintf(tile_name, "Tile[%02d][%02d]_(#%d)", i, j, tile_id);
 	    t[i][j] = new Tile(tile_name, tile_id);
+	    tiles.push_back(t[i][j]);
 
 	    // Tell to the router its coordinates
 	    t[i][j]->r->configure(j * GlobalParams::mesh_dim_x + i,
@@ -2207,6 +2256,16 @@ void NoC::buildMesh()
 			 t[i][j]->pe->traffic_table = &gttable;	// Needed to choose destination
 	   		 t[i][j]->pe->never_transmit = (gttable.occurrencesAsSource(t[i][j]->pe->local_id) == 0);
 		}
+		else if (GlobalParams::traffic_distribution == TRAFFIC_TRACE)
+		{
+			t[i][j]->pe->traffic_trace = &traffic_trace;	// Needed to replay the packets
+			t[i][j]->pe->never_transmit = (traffic_trace.packetsOfSource(t[i][j]->pe->local_id) == 0);
+		}
+		else if (GlobalParams::traffic_distribution == TRAFFIC_MATRIX)
+		{
+			t[i][j]->pe->traffic_matrix = &gtmatrix;	// Needed to choose destination
+			t[i][j]->pe->never_transmit = gtmatrix.getWeights(t[i][j]->pe->local_id).empty();
+		}
 		else
 			t[i][j]->pe->never_transmit = false;
 
@@ -2377,7 +2436,8 @@ Tile *NoC::searchNode(const int id) const
 void NoC::asciiMonitor()
 {
 	//cout << sc_time_stamp().to_double()/GlobalParams::clock_period_ps << endl;
-	system("clear");
+	// clear the terminal without spawning a shell at every cycle
+	std::printf("\033[H\033[2J");
 	//
 	// asciishow proof-of-concept #1 free slots
 
@@ -2405,3 +2465,110 @@ void NoC::asciiMonitor()
 	}
 }
 
+
+void NoC::partitionMesh()
+{
+    int dimX = GlobalParams::mesh_dim_x;
+    int dimY = GlobalParams::mesh_dim_y;
+    int threads = min(GlobalParams::parallel_threads, dimX * dimY);
+
+    // Split the mesh into nx*ny rectangular regions, one for each
+    // thread. Among the feasible shapes, the one with the shortest region
+    // border (i.e. the fewest links crossing regions) is chosen
+    int nx = 0;
+    int ny = 0;
+    while (nx == 0)
+    {
+	int best_border = 0;
+
+	for (int x = 1; x <= threads; x++)
+	{
+	    int y = threads / x;
+
+	    if (x * y != threads || x > dimX || y > dimY)
+		continue;
+
+	    int border = (dimX + x - 1) / x + (dimY + y - 1) / y;
+
+	    if (nx == 0 || border < best_border)
+	    {
+		nx = x;
+		ny = y;
+		best_border = border;
+	    }
+	}
+
+	if (nx == 0)
+	    threads--;
+    }
+
+    if (threads != GlobalParams::parallel_threads)
+	cout << "WARNING: the mesh cannot be split into " << GlobalParams::parallel_threads
+	     << " regions, using " << threads << " threads" << endl;
+
+    vector < vector <Tile*> > regions;
+
+    for (int ry = 0; ry < ny; ry++)
+	for (int rx = 0; rx < nx; rx++)
+	{
+	    vector <Tile*> region;
+
+	    // tiles are kept in construction order
+	    for (int j = ry * dimY / ny; j < (ry + 1) * dimY / ny; j++)
+		for (int i = rx * dimX / nx; i < (rx + 1) * dimX / nx; i++)
+		    region.push_back(t[i][j]);
+
+	    regions.push_back(region);
+	}
+
+    parallel_kernel = new ParallelKernel(regions);
+}
+
+void NoC::stopParallelKernel()
+{
+    delete parallel_kernel;
+    parallel_kernel = NULL;
+}
+
+void NoC::fastKernelProcess()
+{
+    fast_kernel_cycle++;
+
+    if (parallel_kernel != NULL)
+    {
+	// both phases are carried out by the region threads
+	parallel_kernel->step(fast_kernel_cycle);
+	return;
+    }
+
+    // Evaluate phase: processes are called in the same order in which
+    // they would be registered as SC_METHODs. Every module reads the
+    // values committed at the previous clock edge and writes the next
+    // ones, so the outcome does not depend on signal update timing
+    if (GlobalParams::use_winoc)
+    {
+	token_ring->fastKernelProcess();
+
+	for (map<int, Hub*>::iterator it = hub.begin(); it != hub.end(); ++it)
+	{
+	    it->second->tileToAntennaProcess();
+	    it->second->antennaToTileProcess();
+	}
+    }
+
+    for (unsigned int i = 0; i < tiles.size(); i++)
+    {
+	// idle routers and PEs are skipped until an input wakes them up
+	tiles[i]->r->fastKernelProcess(fast_kernel_cycle);
+	tiles[i]->pe->fastKernelProcess(fast_kernel_cycle);
+    }
+
+    // Commit phase: the values written above become visible all together
+    FastSignalBase::commitAll();
+}
+
+void NoC::accountSleepingRouters()
+{
+    for (unsigned int i = 0; i < tiles.size(); i++)
+	tiles[i]->r->accountSleep(fast_kernel_cycle + 1);
+}
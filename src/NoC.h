@@ -14,31 +14,34 @@
 #include <systemc.h>
 #include "Tile.h"
 #include "GlobalRoutingTable.h"
+#include "TrafficTrace.h"
 #include "GlobalTrafficTable.h"
 #include "Hub.h"
 #include "Channel.h"
 #include "TokenRing.h"
+#include "FastSignal.h"
+#include "ParallelKernel.h"
 
 using namespace std;
 
 template <typename T>
 struct sc_signal_NSWE
 {
-    sc_signal<T> east;
-    sc_signal<T> west;
-    sc_signal<T> south;
-    sc_signal<T> north;
+    FastSignal<T> east;
+    FastSignal<T> west;
+    FastSignal<T> south;
+    FastSignal<T> north;
 };
 
 template <typename T>
 struct sc_signal_NSWEH
 {
-    sc_signal<T> east;
-    sc_signal<T> west;
-    sc_signal<T> south;
-    sc_signal<T> north;
-    sc_signal<T> to_hub;
-    sc_signal<T> from_hub;
+    FastSignal<T> east;
+    FastSignal<T> west;
+    FastSignal<T> south;
+    FastSignal<T> north;
+    FastSignal<T> to_hub;
+    FastSignal<T> from_hub;
 };
 
 
@@ -60,17 +63,17 @@ SC_MODULE(NoC)
     sc_signal_NSWE<NoP_data> **nop_data;
 
     //signals for connecting Core2Hub (just to test wireless in Butterfly)
-    sc_signal<Flit> *flit_from_hub;
-    sc_signal<Flit> *flit_to_hub;
+    FastSignal<Flit> *flit_from_hub;
+    FastSignal<Flit> *flit_to_hub;
 
-    sc_signal<bool> *req_from_hub;
-    sc_signal<bool> *req_to_hub;
+    FastSignal<bool> *req_from_hub;
+    FastSignal<bool> *req_to_hub;
 
-    sc_signal<bool> *ack_from_hub;
-    sc_signal<bool> *ack_to_hub;
+    FastSignal<bool> *ack_from_hub;
+    FastSignal<bool> *ack_to_hub;
 
-    sc_signal<TBufferFullStatus> *buffer_full_status_from_hub;
-    sc_signal<TBufferFullStatus> *buffer_full_status_to_hub;
+    FastSignal<TBufferFullStatus> *buffer_full_status_from_hub;
+    FastSignal<TBufferFullStatus> *buffer_full_status_to_hub;
 
 
 
@@ -78,6 +81,15 @@ SC_MODULE(NoC)
     Tile ***t;
     Tile ** core;
 
+    // All the tiles, in construction order (evaluation order of the fast kernel)
+    vector<Tile*> tiles;
+
+    // Evaluates the mesh regions on separate threads (parallel mode only)
+    ParallelKernel * parallel_kernel;
+
+    // Number of clock cycles evaluated by the fast kernel
+    unsigned long fast_kernel_cycle;
+
     map<int, Hub*> hub;
     map<int, Channel*> channel;
 
@@ -86,6 +98,8 @@ SC_MODULE(NoC)
     // Global tables
     GlobalRoutingTable grtable;
     GlobalTrafficTable gttable;
+    TrafficTrace traffic_trace;
+    TrafficMatrix gtmatrix;
 
 
     // Constructor
@@ -111,6 +125,18 @@ SC_MODULE(NoC)
 	// out of yaml configuration (experimental features)
 	//GlobalParams::channel_selection = CHSEL_FIRST_FREE;
 
+	fast_kernel_cycle = 0;
+	parallel_kernel = NULL;
+	if (GlobalParams::parallel_threads > 0)
+	    partitionMesh();
+
+	if (GlobalParams::fast_kernel)
+	{
+	    SC_METHOD(fastKernelProcess);
+	    sensitive << reset;
+	    sensitive << clock.pos();
+	}
+
 	if (GlobalParams::ascii_monitor)
 	{
 	    SC_METHOD(asciiMonitor);
@@ -122,6 +148,14 @@ SC_MODULE(NoC)
     // Support methods
     Tile *searchNode(const int id) const;
 
+    // Accounts the cycles sleeping routers have not been evaluated so
+    // far (fast kernel only), to be called before collecting statistics
+    void accountSleepingRouters();
+
+    // Stops and joins the threads of the parallel kernel, to be called
+    // once the simulation is over
+    void stopParallelKernel();
+
   private:
 
     void buildMesh();
@@ -129,7 +163,9 @@ SC_MODULE(NoC)
     void buildBaseline();
     void buildOmega();
     void buildCommon();
+    void partitionMesh();
     void asciiMonitor();
+    void fastKernelProcess();
     int * hub_connected_ports;
 };
 
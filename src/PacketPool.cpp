@@ -0,0 +1,76 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the pool of the descriptors
+ * of the packets in flight
+ */
+
+#include "PacketPool.h"
+
+vector < PacketPool::Owner > PacketPool::owners;
+
+void PacketPool::addOwner(const int owner_id)
+{
+    assert(owner_id >= 0 && owner_id < (1 << (32 - PACKET_OWNER_SHIFT)) - 1);
+
+    if ((unsigned int) owner_id >= owners.size())
+    {
+	Owner empty;
+
+	for (int i = 0; i < PACKET_MAX_BLOCKS; i++)
+	    empty.blocks[i] = NULL;
+	empty.n_blocks = 0;
+	empty.n_slots = 0;
+	empty.cursor = 0;
+
+	owners.resize(owner_id + 1, empty);
+    }
+}
+
+unsigned int PacketPool::allocate(const int owner_id)
+{
+    Owner & owner = owners[owner_id];
+    unsigned int s;
+
+    // packets are mostly delivered in the order they are injected, so a
+    // free slot is usually found right after the last one allocated
+    for (unsigned int i = 0; i < owner.n_slots; i++)
+    {
+	s = owner.cursor;
+	owner.cursor = (owner.cursor + 1 == owner.n_slots) ? 0 : owner.cursor + 1;
+
+	Slot & candidate = slot(owner, s);
+
+	if (!candidate.in_use.load(memory_order_acquire))
+	{
+	    candidate.in_use.store(true, memory_order_relaxed);
+	    return (owner_id << PACKET_OWNER_SHIFT) | s;
+	}
+    }
+
+    // all the slots are in use: add a block, doubling them
+    assert(owner.n_blocks < PACKET_MAX_BLOCKS && "too many packets in flight from the same PE");
+
+    unsigned int block_size = owner.n_blocks ? owner.n_slots : 1 << PACKET_BLOCK_BITS;
+    Slot * block = new Slot[block_size];
+
+    for (unsigned int i = 0; i < block_size; i++)
+	block[i].in_use.store(false, memory_order_relaxed);
+
+    owner.blocks[owner.n_blocks++] = block;
+    s = owner.n_slots;
+    owner.n_slots += block_size;
+    owner.cursor = s + 1;
+
+    block[0].in_use.store(true, memory_order_relaxed);
+    return (owner_id << PACKET_OWNER_SHIFT) | s;
+}
+
+void PacketPool::release(const unsigned int packet_id)
+{
+    slot(packet_id).in_use.store(false, memory_order_release);
+}
@@ -0,0 +1,111 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the pool of the descriptors of
+ * the packets in flight
+ */
+
+#ifndef __NOXIMPACKETPOOL_H__
+#define __NOXIMPACKETPOOL_H__
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+// PacketDescriptor -- fields shared by all the flits of a packet
+struct PacketDescriptor {
+    int src_id;
+    int dst_id;
+    int vc_id;			// Virtual Channel
+    int sequence_length;
+    double timestamp;		// Unix timestamp at packet generation
+    int hop_no;			// Current number of hops from source to destination
+    bool use_low_voltage_path;
+    int hub_relay_node;
+
+    // Set by the routers with -latency_breakdown only (hop_no as well)
+    double network_entry;	// Head flit stored by the source router
+    double hop_arrival;		// Head flit stored by the current router
+    double contention;		// Cycles the head flit waited beyond the router pipeline
+    double head_ejection;	// Head flit delivered to the destination PE
+};
+
+// Handles of the packets, bits [31:16] hold the id of the source PE
+// and bits [15:0] the slot of the descriptor among those of the source
+#define PACKET_OWNER_SHIFT	16
+#define PACKET_SLOT_MASK	0xffff
+#define PACKET_BLOCK_BITS	4	// the first block holds 16 descriptors, each next one doubles
+#define PACKET_MAX_BLOCKS	(16 - PACKET_BLOCK_BITS + 1)
+#define PACKET_NOT_VALID	0xffffffffu
+
+// The descriptor of a packet is allocated by its source PE when the
+// head flit is injected, and released by the destination PE when the
+// tail flit is ejected. Every PE allocates from its own slots, so that
+// PEs evaluated by different threads never share the allocator state:
+// only the in-use flag of a slot is written by two threads. The slots
+// are added in blocks as large as all the previous ones, so that the
+// PEs which inject few packets at a time keep a few descriptors
+class PacketPool {
+  public:
+
+    // Makes the PE with the given id able to allocate descriptors. To be
+    // called during the elaboration
+    static void addOwner(const int owner_id);
+
+    static unsigned int allocate(const int owner_id);
+    static void release(const unsigned int packet_id);
+
+    static PacketDescriptor & get(const unsigned int packet_id)
+    {
+	return slot(packet_id).descriptor;
+    }
+
+  private:
+
+    struct Slot {
+	PacketDescriptor descriptor;
+	atomic < bool > in_use;
+    };
+
+    struct Owner {
+	Slot * blocks[PACKET_MAX_BLOCKS];
+	unsigned int n_blocks;
+	unsigned int n_slots;
+	unsigned int cursor;	// next slot to be checked by allocate()
+    };
+
+    // Block 0 holds the slots below 1 << PACKET_BLOCK_BITS, block b > 0
+    // those from (1 << PACKET_BLOCK_BITS) << (b - 1) to twice as much
+    static Slot & slot(const Owner & owner, const unsigned int s)
+    {
+	unsigned int high = s >> PACKET_BLOCK_BITS;
+
+	if (high == 0)
+	    return owner.blocks[0][s];
+
+	unsigned int b = 32 - __builtin_clz(high);
+
+	return owner.blocks[b][s - (1u << (PACKET_BLOCK_BITS + b - 1))];
+    }
+
+    // The slots of a handle are in a block published before the handle
+    // itself, so they can be read by any thread while the owner is adding
+    // blocks (n_slots is not, hence not checked here)
+    static Slot & slot(const unsigned int packet_id)
+    {
+	assert(packet_id != PACKET_NOT_VALID && (packet_id >> PACKET_OWNER_SHIFT) < owners.size());
+
+	return slot(owners[packet_id >> PACKET_OWNER_SHIFT], packet_id & PACKET_SLOT_MASK);
+    }
+
+    static vector < Owner > owners;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the parallel kernel
+ */
+
+#include "ParallelKernel.h"
+
+// Number of polls of the barrier before a thread goes to sleep. Cycles
+// are short, so waiting threads usually leave the barrier while spinning
+#define BARRIER_SPIN_LIMIT 20000
+
+ParallelKernel::ParallelKernel(const vector < vector <Tile*> > & _regions)
+{
+    assert(_regions.size() > 0);
+
+    regions = _regions;
+    n_threads = regions.size();
+    arrived = 0;
+    generation = 0;
+    stopping = false;
+    current_cycle = 0;
+
+    for (unsigned int r = 1; r < n_threads; r++)
+	workers.push_back(thread(&ParallelKernel::worker, this, r));
+}
+
+ParallelKernel::~ParallelKernel()
+{
+    stopping = true;
+    barrier();
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+	workers[i].join();
+}
+
+unsigned int ParallelKernel::getThreads() const
+{
+    return n_threads;
+}
+
+void ParallelKernel::step(const unsigned long cycle)
+{
+    current_cycle = cycle;
+    barrier();		// start the workers
+    evaluate(0, cycle);
+    barrier();		// every region has been evaluated
+    FastSignalBase::commitAll();
+    barrier();		// every region has been committed
+}
+
+void ParallelKernel::worker(const unsigned int region)
+{
+    while (true)
+    {
+	barrier();
+	if (stopping)
+	    return;
+
+	evaluate(region, current_cycle);
+	barrier();
+	FastSignalBase::commitAll();
+	barrier();
+    }
+}
+
+void ParallelKernel::evaluate(const unsigned int region, const unsigned long cycle)
+{
+    vector <Tile*> & tiles = regions[region];
+
+    for (unsigned int i = 0; i < tiles.size(); i++)
+    {
+	tiles[i]->r->fastKernelProcess(cycle);
+	tiles[i]->pe->fastKernelProcess(cycle);
+    }
+}
+
+void ParallelKernel::barrier()
+{
+    if (n_threads == 1)
+	return;
+
+    unsigned int current = generation.load();
+
+    if (arrived.fetch_add(1) + 1 == n_threads)
+    {
+	// last thread to arrive: open the barrier
+	arrived = 0;
+	{
+	    lock_guard <mutex> lock(barrier_mutex);
+	    generation++;
+	}
+	barrier_cv.notify_all();
+	return;
+    }
+
+    for (int i = 0; i < BARRIER_SPIN_LIMIT; i++)
+	if (generation.load() != current)
+	    return;
+
+    unique_lock <mutex> lock(barrier_mutex);
+    while (generation.load() == current)
+	barrier_cv.wait(lock);
+}
@@ -0,0 +1,62 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the parallel kernel, which
+ * evaluates the regions of a partitioned mesh on separate threads
+ */
+
+#ifndef __NOXIMPARALLELKERNEL_H__
+#define __NOXIMPARALLELKERNEL_H__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "Tile.h"
+#include "FastSignal.h"
+
+using namespace std;
+
+// Every region is evaluated by its own thread, region 0 by the SystemC
+// thread calling step(). Threads meet at a barrier after the evaluate
+// phase and again after the commit phase, so that a region never reads
+// a signal of a neighbor region while it is being committed: border
+// links are double-buffered by FastSignal (current/next value).
+// Routers and PEs draw their random numbers from private streams, hence
+// the results do not depend on the number of regions
+class ParallelKernel {
+  public:
+
+    ParallelKernel(const vector < vector <Tile*> > & _regions);
+    ~ParallelKernel();
+
+    // Evaluates one clock cycle of all the regions
+    void step(const unsigned long cycle);
+
+    unsigned int getThreads() const;
+
+  private:
+
+    void worker(const unsigned int region);
+    void evaluate(const unsigned int region, const unsigned long cycle);
+    void barrier();
+
+    vector < vector <Tile*> > regions;
+    vector <thread> workers;
+
+    // barrier state
+    unsigned int n_threads;
+    atomic <unsigned int> arrived;
+    atomic <unsigned int> generation;
+    mutex barrier_mutex;
+    condition_variable barrier_cv;
+    bool stopping;
+    unsigned long current_cycle;	// cycle being evaluated, published by step()
+};
+
+#endif
@@ -403,9 +403,9 @@ void Power::biasingTx()
 // is assumed as loaded with the proper values from configuration file:
 // - Router: takes the value of input buffers leakage
 // - Hub: takes the leakage value of buffer_from_tile/to_tile
-void Power::leakageBufferRouter()
+void Power::leakageBufferRouter(const unsigned int cycles)
 {
-    power_static.breakdown[BUFFER_ROUTER_PWR_S].value +=buffer_router_pwr_s;
+    power_static.breakdown[BUFFER_ROUTER_PWR_S].value +=buffer_router_pwr_s * cycles;
 }
 
 void Power::leakageBufferToTile()
@@ -424,24 +424,24 @@ void Power::leakageAntennaBuffer()
     power_static.breakdown[ANTENNA_BUFFER_PWR_S].value +=(antenna_buffer_pwr_s);
 }
 
-void Power::leakageLinkRouter2Router()
+void Power::leakageLinkRouter2Router(const unsigned int cycles)
 {
-    //power_static.breakdown[LINK_R2R_PWR_S].value +=link_r2r_pwr_s;
+    //power_static.breakdown[LINK_R2R_PWR_S].value +=link_r2r_pwr_s * cycles;
 }
 
-void Power::leakageLinkRouter2Hub()
+void Power::leakageLinkRouter2Hub(const unsigned int cycles)
 {
-    power_static.breakdown[LINK_R2H_PWR_S].value +=link_r2h_pwr_s;
+    power_static.breakdown[LINK_R2H_PWR_S].value +=link_r2h_pwr_s * cycles;
 }
 
-void Power::leakageRouter()
+void Power::leakageRouter(const unsigned int cycles)
 {
     // note: leakage contributions depending on instance number are 
     // accounted in specific separate leakage functions
-    power_static.breakdown[ROUTING_PWR_S].value +=routing_pwr_s;
-    power_static.breakdown[SELECTION_PWR_S].value +=selection_pwr_s;
-    power_static.breakdown[CROSSBAR_PWR_S].value +=crossbar_pwr_s;
-    power_static.breakdown[NI_PWR_S].value +=ni_pwr_s;
+    power_static.breakdown[ROUTING_PWR_S].value +=routing_pwr_s * cycles;
+    power_static.breakdown[SELECTION_PWR_S].value +=selection_pwr_s * cycles;
+    power_static.breakdown[CROSSBAR_PWR_S].value +=crossbar_pwr_s * cycles;
+    power_static.breakdown[NI_PWR_S].value +=ni_pwr_s * cycles;
 }
 
 
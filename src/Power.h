@@ -67,13 +67,15 @@ class Power {
     void r2rLink(); 
     void networkInterface();
 
-    void leakageBufferRouter();
+    // router leakage can be accounted for several cycles at once
+    // (cycles a sleeping router has not been evaluated)
+    void leakageBufferRouter(const unsigned int cycles = 1);
     void leakageBufferToTile();
     void leakageBufferFromTile();
     void leakageAntennaBuffer();
-    void leakageLinkRouter2Router();
-    void leakageLinkRouter2Hub();
-    void leakageRouter();
+    void leakageLinkRouter2Router(const unsigned int cycles = 1);
+    void leakageLinkRouter2Hub(const unsigned int cycles = 1);
+    void leakageRouter(const unsigned int cycles = 1);
     void leakageTransceiverRx();
     void leakageTransceiverTx();
     void biasingRx();
@@ -12,8 +12,7 @@
 
 int ProcessingElement::randInt(int min, int max)
 {
-    return min +
-	(int) ((double) (max - min + 1) * rand() / (RAND_MAX + 1.0));
+    return min + rng.below(max - min + 1);
 }
 
 void ProcessingElement::rxProcess()
@@ -23,7 +22,11 @@ void ProcessingElement::rxProcess()
 	current_level_rx = 0;
     } else {
 	if (req_rx.read() == 1 - current_level_rx) {
-	    Flit flit_tmp = flit_rx.read();
+	    const Flit & flit = flit_rx.read();
+
+	    // the packet has been ejected
+	    if (flit.flit_type == FLIT_TYPE_TAIL)
+		PacketPool::release(flit.packet_id);
 	    current_level_rx = 1 - current_level_rx;	// Negate the old value for Alternating Bit Protocol (ABP)
 	}
 	ack_rx.write(current_level_rx);
@@ -36,6 +39,10 @@ void ProcessingElement::txProcess()
 	req_tx.write(0);
 	current_level_tx = 0;
 	transmittedAtPreviousCycle = false;
+	next_injection = NOT_VALID;
+	rng.seed(GlobalParams::rnd_generator_seed, RANDOM_STREAM_PE, local_id);
+	if (traffic_trace)
+	    traffic_trace->rewind(trace_cursor, local_id);
     } else {
 	Packet packet;
 
@@ -57,21 +64,94 @@ void ProcessingElement::txProcess()
     }
 }
 
+void ProcessingElement::end_of_elaboration()
+{
+    PacketPool::addOwner(local_id);
+
+    if (usesDestinationTable() && !never_transmit)
+	destinations.configure(local_id, traffic_matrix);
+
+    if (GlobalParams::fast_kernel)
+	can_sleep = wakeupOnChange(req_rx, wakeup);
+}
+
+void ProcessingElement::fastKernelProcess(const unsigned long cycle)
+{
+    if (reset.read())
+	sleeping = false;
+    else if (sleeping)
+    {
+	if (!wakeup && cycle < wake_cycle)
+	    return;
+
+	sleeping = false;
+    }
+
+    wakeup = false;
+
+    rxProcess();
+    txProcess();
+
+    if (!can_sleep || reset.read() || !packet_queue.empty())
+	return;
+
+    // a PE that never transmits is only woken up by incoming flits,
+    // otherwise also by its next injection, when known in advance
+    if (never_transmit)
+    {
+	sleeping = true;
+	wake_cycle = ULONG_MAX;
+    }
+    else if (GlobalParams::traffic_distribution == TRAFFIC_TRACE)
+    {
+	sleeping = true;
+	if (trace_cursor.done())
+	    wake_cycle = ULONG_MAX;
+	else
+	{
+	    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+	    double gap = GlobalParams::reset_time + trace_cursor.next->cycle - now;
+
+	    wake_cycle = cycle + (unsigned long) max(gap, 0.0);
+	}
+    }
+    else if (GlobalParams::geometric_injection)
+    {
+	double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+	double gap = next_injection - now;
+
+	sleeping = true;
+	if (gap < ULONG_MAX - cycle)
+	    wake_cycle = cycle + (unsigned long) gap;
+	else
+	    wake_cycle = ULONG_MAX;
+    }
+}
+
 Flit ProcessingElement::nextFlit()
 {
     Flit flit;
-    Packet packet = packet_queue.front();
+    Packet & packet = packet_queue.front();
 
-    flit.src_id = packet.src_id;
-    flit.dst_id = packet.dst_id;
-    flit.vc_id = packet.vc_id;
-    flit.timestamp = packet.timestamp;
-    flit.sequence_no = packet.size - packet.flit_left;
-    flit.sequence_length = packet.size;
-    flit.hop_no = 0;
-    //  flit.payload     = DEFAULT_PAYLOAD;
+    // the fields shared by the flits are set once, at the head flit
+    if (packet.size == packet.flit_left)
+    {
+	packet.packet_id = PacketPool::allocate(local_id);
+
+	PacketDescriptor & descriptor = PacketPool::get(packet.packet_id);
+
+	descriptor.src_id = packet.src_id;
+	descriptor.dst_id = packet.dst_id;
+	descriptor.vc_id = packet.vc_id;
+	descriptor.timestamp = packet.timestamp;
+	descriptor.sequence_length = packet.size;
+	descriptor.hop_no = 0;
+	descriptor.use_low_voltage_path = packet.use_low_voltage_path;
+	descriptor.hub_relay_node = NOT_VALID;
+    }
 
-    flit.hub_relay_node = NOT_VALID;
+    flit.packet_id = packet.packet_id;
+    flit.sequence_no = packet.size - packet.flit_left;
 
     if (packet.size == packet.flit_left)
 	flit.flit_type = FLIT_TYPE_HEAD;
@@ -80,8 +160,8 @@ Flit ProcessingElement::nextFlit()
     else
 	flit.flit_type = FLIT_TYPE_BODY;
 
-    packet_queue.front().flit_left--;
-    if (packet_queue.front().flit_left == 0)
+    packet.flit_left--;
+    if (packet.flit_left == 0)
 	packet_queue.pop();
 
     return flit;
@@ -108,6 +188,12 @@ bool ProcessingElement::canShot(Packet & packet)
     if (local_id%2==0)
 	return false;
 #endif
+    if (GlobalParams::traffic_distribution == TRAFFIC_TRACE)
+	return traceShot(packet);
+
+    if (GlobalParams::geometric_injection)
+	return scheduledShot(packet);
+
     bool shot;
     double threshold;
 
@@ -119,198 +205,235 @@ bool ProcessingElement::canShot(Packet & packet)
 	else
 	    threshold = GlobalParams::probability_of_retransmission;
 
-	shot = (((double) rand()) / RAND_MAX < threshold);
-	if (shot) {
-	    if (GlobalParams::traffic_distribution == TRAFFIC_RANDOM)
-		    packet = trafficRandom();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_TRANSPOSE1)
-		    packet = trafficTranspose1();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_TRANSPOSE2)
-    		packet = trafficTranspose2();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_BIT_REVERSAL)
-		    packet = trafficBitReversal();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_SHUFFLE)
-		    packet = trafficShuffle();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_BUTTERFLY)
-		    packet = trafficButterfly();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_LOCAL)
-		    packet = trafficLocal();
-        else if (GlobalParams::traffic_distribution == TRAFFIC_ULOCAL)
-		    packet = trafficULocal();
-        else {
-            cout << "Invalid traffic distribution: " << GlobalParams::traffic_distribution << endl;
-            exit(-1);
-        }
-	}
+	shot = (rng.uniform() < threshold);
+	if (shot)
+	    packet = generatePacket();
     } else {			// Table based communication traffic
 	if (never_transmit)
 	    return false;
 
 	bool use_pir = (transmittedAtPreviousCycle == false);
-	vector < pair < int, double > > dst_prob;
+	const vector < pair < int, double > > * dst_prob;
 	double threshold =
 	    traffic_table->getCumulativePirPor(local_id, (int) now, use_pir, dst_prob);
 
-	double prob = (double) rand() / RAND_MAX;
+	double prob = rng.uniform();
 	shot = (prob < threshold);
-	if (shot) {
-	    for (unsigned int i = 0; i < dst_prob.size(); i++) {
-		if (prob < dst_prob[i].second) {
-                    int vc = randInt(0,GlobalParams::n_virtual_channels-1);
-		    packet.make(local_id, dst_prob[i].first, vc, now, getRandomSize());
-		    break;
-		}
-	    }
-	}
+	if (shot)
+	    makeTablePacket(packet, prob, *dst_prob, now);
     }
 
     return shot;
 }
 
+Packet ProcessingElement::generatePacket()
+{
+    Packet packet;
+
+    if (usesDestinationTable())
+	packet = trafficRandom();
+    else if (GlobalParams::traffic_distribution == TRAFFIC_TRANSPOSE1)
+	packet = trafficTranspose1();
+    else if (GlobalParams::traffic_distribution == TRAFFIC_TRANSPOSE2)
+	packet = trafficTranspose2();
+    else if (GlobalParams::traffic_distribution == TRAFFIC_BIT_REVERSAL)
+	packet = trafficBitReversal();
+    else if (GlobalParams::traffic_distribution == TRAFFIC_SHUFFLE)
+	packet = trafficShuffle();
+    else if (GlobalParams::traffic_distribution == TRAFFIC_BUTTERFLY)
+	packet = trafficButterfly();
+    else {
+	cout << "Invalid traffic distribution: " << GlobalParams::traffic_distribution << endl;
+	exit(-1);
+    }
 
-Packet ProcessingElement::trafficLocal()
+    return packet;
+}
+
+// The destination is the first one whose cumulative probability exceeds prob
+void ProcessingElement::makeTablePacket(Packet & packet, const double prob,
+					const vector < pair < int, double > > & dst_prob,
+					const double now)
 {
-    Packet p;
-    p.src_id = local_id;
-    double rnd = rand() / (double) RAND_MAX;
+    for (unsigned int i = 0; i < dst_prob.size(); i++) {
+	if (prob < dst_prob[i].second) {
+	    int vc = randInt(0,GlobalParams::n_virtual_channels-1);
+	    packet.make(local_id, dst_prob[i].first, vc, now, getRandomSize());
+	    break;
+	}
+    }
+}
 
-    vector<int> dst_set;
+// Geometric-skip injection. Rather than drawing a Bernoulli trial at
+// every cycle, the cycle of the next injection is sampled in advance
+// from the distribution of the gap between two injections: geometric
+// with the packet injection rate, except for the cycle following an
+// injection, which uses the probability of retransmission
+bool ProcessingElement::scheduledShot(Packet & packet)
+{
+    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+    if (next_injection == NOT_VALID)
+    {
+	next_injection = nextInjection(now);
+	next_injection_por = false;
+    }
+
+    if (now < next_injection)
+	return false;
 
-    int max_id = (GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y);
+    double change_cycle;
 
-    for (int i=0;i<max_id;i++)
+    if (GlobalParams::traffic_distribution != TRAFFIC_TABLE_BASED)
+	packet = generatePacket();
+    else
     {
-	if (rnd<=GlobalParams::locality)
-	{
-	    if (local_id!=i && sameRadioHub(local_id,i))
-		dst_set.push_back(i);
-	}
-	else
-	    if (!sameRadioHub(local_id,i))
-		dst_set.push_back(i);
+	// the probabilities of the destinations are rescaled, since the
+	// injection is known to take place
+	const vector < pair < int, double > > * dst_prob;
+	double threshold =
+	    traffic_table->getCumulativePirPor(local_id, (int) now, !next_injection_por, dst_prob);
+	double prob = threshold * rng.uniform();
+
+	makeTablePacket(packet, prob, *dst_prob, now);
     }
 
+    double por = injectionProbability(now + 1, false, change_cycle);
 
-    int i_rnd = rand()%dst_set.size();
+    next_injection_por = (rng.uniform() < por);
+    if (next_injection_por)
+	next_injection = now + 1;
+    else
+	next_injection = nextInjection(now + 2);
 
-    p.dst_id = dst_set[i_rnd];
-    p.timestamp = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
-    p.size = p.flit_left = getRandomSize();
-    p.vc_id = randInt(0,GlobalParams::n_virtual_channels-1);
-    
-    return p;
+    return true;
 }
 
-
-int ProcessingElement::findRandomDestination(int id, int hops)
+// Trace replay. The packets of the source are injected at the cycles of
+// the trace (counted from the end of the reset), one per cycle at most:
+// the packets of a cycle which are late keep their timestamp, so that
+// the delay is accounted in their latency
+bool ProcessingElement::traceShot(Packet & packet)
 {
-    assert(GlobalParams::topology == TOPOLOGY_MESH);
+    if (trace_cursor.done())
+	return false;
 
-    int inc_y = rand()%2?-1:1;
-    int inc_x = rand()%2?-1:1;
-    
-    Coord current =  id2Coord(id);
-    
+    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+    const TraceRecord & record = *trace_cursor.next;
+    double cycle = GlobalParams::reset_time + record.cycle;
 
+    if (now < cycle)
+	return false;
 
-    for (int h = 0; h<hops; h++)
-    {
+    int n_tiles;
 
-	if (current.x==0)
-	    if (inc_x<0) inc_x=0;
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+	n_tiles = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    else
+	n_tiles = GlobalParams::n_delta_tiles;
 
-	if (current.x== GlobalParams::mesh_dim_x-1)
-	    if (inc_x>0) inc_x=0;
+    if (record.dst_id >= n_tiles)
+    {
+	cerr << "Error: the traffic trace sends from " << local_id << " to "
+	     << record.dst_id << ", which is out of the network" << endl;
+	exit(1);
+    }
 
-	if (current.y==0)
-	    if (inc_y<0) inc_y=0;
+    // a packet without a tail flit would keep its path reserved
+    if (record.size < 2)
+    {
+	cerr << "Error: the traffic trace sends a packet of " << record.size
+	     << " flits from " << local_id << ", packet size must be >= 2" << endl;
+	exit(1);
+    }
 
-	if (current.y==GlobalParams::mesh_dim_y-1)
-	    if (inc_y>0) inc_y=0;
+    int vc = randInt(0,GlobalParams::n_virtual_channels-1);
+    packet.make(local_id, record.dst_id, vc, cycle, record.size);
 
-	if (rand()%2)
-	    current.x +=inc_x;
-	else
-	    current.y +=inc_y;
-    }
-    return coord2Id(current);
-}
+    traffic_trace->advance(trace_cursor);
 
+    return true;
+}
 
-int roulette()
+// Returns the injection probability (packet injection rate or probability
+// of retransmission) at the given cycle, along with the cycle from which
+// it could change
+double ProcessingElement::injectionProbability(const double cycle, const bool pir_not_por,
+					       double & change_cycle)
 {
-    int slices = GlobalParams::mesh_dim_x + GlobalParams::mesh_dim_y -2;
+    if (GlobalParams::traffic_distribution != TRAFFIC_TABLE_BASED)
+    {
+	change_cycle = HUGE_VAL;
+	return pir_not_por ? GlobalParams::packet_injection_rate : GlobalParams::probability_of_retransmission;
+    }
 
+    // activity windows of the table are not considered beyond the end
+    // of the simulation
+    if (cycle >= GlobalParams::reset_time + GlobalParams::simulation_time)
+    {
+	change_cycle = HUGE_VAL;
+	return 0.0;
+    }
 
-    double r = rand()/(double)RAND_MAX;
+    const vector < pair < int, double > > * dst_prob;
 
+    change_cycle = traffic_table->getNextActivityChange(local_id, (int) cycle);
+    return traffic_table->getCumulativePirPor(local_id, (int) cycle, pir_not_por, dst_prob);
+}
 
-    for (int i=1;i<=slices;i++)
+// Returns the first cycle, starting from the given one, in which a packet
+// is injected at the packet injection rate (HUGE_VAL if none)
+double ProcessingElement::nextInjection(double cycle)
+{
+    while (cycle != HUGE_VAL)
     {
-	if (r< (1-1/double(2<<i)))
+	double change_cycle;
+	double pir = injectionProbability(cycle, true, change_cycle);
+
+	// the gap is memoryless, so it can be sampled again from the
+	// beginning of the next activity window
+	if (pir > 0.0)
 	{
-	    return i;
+	    double shot = cycle + sampleGeometric(pir) - 1;
+
+	    if (shot < change_cycle)
+		return shot;
 	}
+
+	cycle = change_cycle;
     }
-    assert(false);
-    return 1;
-}
 
+    return HUGE_VAL;
+}
 
-Packet ProcessingElement::trafficULocal()
+// Number of Bernoulli trials of probability p up to the first success
+double ProcessingElement::sampleGeometric(const double p)
 {
-    Packet p;
-    p.src_id = local_id;
-
-    int target_hops = roulette();
+    if (p >= 1.0)
+	return 1.0;
 
-    p.dst_id = findRandomDestination(local_id,target_hops);
+    double u = 1.0 - rng.uniform();	// in ]0,1]
 
-    p.timestamp = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
-    p.size = p.flit_left = getRandomSize();
-    p.vc_id = randInt(0,GlobalParams::n_virtual_channels-1);
-
-    return p;
+    return floor(log(u) / log(1.0 - p)) + 1.0;
 }
 
+
+// The destinations of the random (with hotspots), local, ulocal and
+// matrix distributions are drawn from the sampler configured at elaboration
 Packet ProcessingElement::trafficRandom()
 {
     Packet p;
     p.src_id = local_id;
-    double rnd = rand() / (double) RAND_MAX;
-    double range_start = 0.0;
-    int max_id;
+    p.dst_id = destinations.sample(rng);
 
-    if (GlobalParams::topology == TOPOLOGY_MESH)
-	max_id = (GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y) - 1; //Mesh 
-    else    // other delta topologies
-	max_id = GlobalParams::n_delta_tiles-1; 
-
-    // Random destination distribution
-    do {
-	p.dst_id = randInt(0, max_id);
-
-	// check for hotspot destination
-	for (size_t i = 0; i < GlobalParams::hotspots.size(); i++) {
-
-	    if (rnd >= range_start && rnd < range_start + GlobalParams::hotspots[i].second) {
-		if (local_id != GlobalParams::hotspots[i].first ) {
-		    p.dst_id = GlobalParams::hotspots[i].first;
-		}
-		break;
-	    } else
-		range_start += GlobalParams::hotspots[i].second;	// try next
-	}
 #ifdef DEADLOCK_AVOIDANCE
-	assert((GlobalParams::topology == TOPOLOGY_MESH));
-	if (p.dst_id%2!=0)
-	{
-	    p.dst_id = (p.dst_id+1)%256;
-	}
+    assert((GlobalParams::topology == TOPOLOGY_MESH));
+    if (p.dst_id%2!=0)
+    {
+	p.dst_id = (p.dst_id+1)%256;
+    }
 #endif
 
-    } while (p.dst_id == p.src_id);
-
     p.timestamp = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
     p.size = p.flit_left = getRandomSize();
     p.vc_id = randInt(0,GlobalParams::n_virtual_channels-1);
@@ -12,11 +12,17 @@
 #define __NOXIMPROCESSINGELEMENT_H__
 
 #include <queue>
+#include <cmath>
+#include <climits>
 #include <systemc.h>
 
 #include "DataStructs.h"
 #include "GlobalTrafficTable.h"
+#include "TrafficTrace.h"
+#include "DestinationTable.h"
 #include "Utils.h"
+#include "FastSignal.h"
+#include "Random.h"
 
 using namespace std;
 
@@ -45,23 +51,45 @@ SC_MODULE(ProcessingElement)
     bool current_level_tx;	// Current level for Alternating Bit Protocol (ABP)
     queue < Packet > packet_queue;	// Local queue of packets
     bool transmittedAtPreviousCycle;	// Used for distributions with memory
+    RandomGenerator rng;	// Private random stream
+
+    // Geometric-skip injection (-geometric_injection)
+    double next_injection;	// Cycle of the next injection (NOT_VALID if not yet sampled)
+    bool next_injection_por;	// The next injection follows the probability of retransmission
+
+    // Activity-driven evaluation (fast kernel only)
+    FastSignalWakeup wakeup;	// Raised when a flit arrives
+    bool can_sleep;		// The incoming requests can raise wakeup
+    bool sleeping;		// Nothing to inject nor receive, not evaluated until woken up
+    unsigned long wake_cycle;	// Kernel cycle of the next injection of a sleeping PE
 
     // Functions
     void rxProcess();		// The receiving process
     void txProcess();		// The transmitting process
+    void fastKernelProcess(const unsigned long cycle);	// rxProcess() and txProcess() unless sleeping
     bool canShot(Packet & packet);	// True when the packet must be shot
+    bool scheduledShot(Packet & packet);	// canShot() with geometric-skip injection
+    bool traceShot(Packet & packet);	// canShot() replaying the traffic trace
+    Packet generatePacket();	// Packet following the traffic distribution
+    void makeTablePacket(Packet & packet, const double prob,
+			 const vector < pair < int, double > > & dst_prob, const double now);
+    double injectionProbability(const double cycle, const bool pir_not_por, double & change_cycle);
+    double nextInjection(double cycle);	// First injection from cycle on
+    double sampleGeometric(const double p);
     Flit nextFlit();	// Take the next flit of the current packet
     Packet trafficTest();	// used for testing traffic
-    Packet trafficRandom();	// Random destination distribution
+    Packet trafficRandom();	// Destination drawn from the destination table
     Packet trafficTranspose1();	// Transpose 1 destination distribution
     Packet trafficTranspose2();	// Transpose 2 destination distribution
     Packet trafficBitReversal();	// Bit-reversal destination distribution
     Packet trafficShuffle();	// Shuffle destination distribution
     Packet trafficButterfly();	// Butterfly destination distribution
-    Packet trafficLocal();	// Random with locality
-    Packet trafficULocal();	// Random with locality
 
     GlobalTrafficTable *traffic_table;	// Reference to the Global traffic Table
+    TrafficTrace *traffic_trace;	// Reference to the traffic trace
+    TraceCursor trace_cursor;	// Next packet of the trace to be injected
+    TrafficMatrix *traffic_matrix;	// Reference to the traffic matrix
+    DestinationSampler destinations;	// Destinations of the spatial traffic distributions
     bool never_transmit;	// true if the PE does not transmit any packet 
     //  (valid only for the table based traffic)
 
@@ -73,20 +101,34 @@ SC_MODULE(ProcessingElement)
     double log2ceil(double x);
 
     int roulett();
-    int findRandomDestination(int local_id,int hops);
     unsigned int getQueueSize() const;
 
     // Constructor
     SC_CTOR(ProcessingElement) {
-	SC_METHOD(rxProcess);
-	sensitive << reset;
-	sensitive << clock.pos();
-
-	SC_METHOD(txProcess);
-	sensitive << reset;
-	sensitive << clock.pos();
+	next_injection = NOT_VALID;
+	next_injection_por = false;
+	wakeup = false;
+	can_sleep = false;
+	sleeping = false;
+	wake_cycle = 0;
+	traffic_trace = NULL;
+	traffic_matrix = NULL;
+
+	// with the fast kernel both processes are driven by NoC
+	if (!GlobalParams::fast_kernel)
+	{
+	    SC_METHOD(rxProcess);
+	    sensitive << reset;
+	    sensitive << clock.pos();
+
+	    SC_METHOD(txProcess);
+	    sensitive << reset;
+	    sensitive << clock.pos();
+	}
     }
 
+  protected:
+    void end_of_elaboration();
 };
 
 #endif
@@ -0,0 +1,99 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the random generator owned by
+ * each simulated component
+ */
+
+#ifndef __NOXIMRANDOM_H__
+#define __NOXIMRANDOM_H__
+
+#include <stdint.h>
+
+// Kinds of components owning a random stream. Together with the id of
+// the component they select the stream drawn from the global seed
+#define RANDOM_STREAM_ROUTER 0
+#define RANDOM_STREAM_PE     1
+#define RANDOM_STREAM_HUB_TX 2
+#define RANDOM_STREAM_HUB_RX 3
+
+// xoshiro128** generator. Every Router and ProcessingElement, and each
+// of the two processes of a Hub, draws from a private stream, so the
+// numbers drawn by a component do not depend on the order in which the
+// processes are evaluated (SystemC scheduler, fast kernel, parallel
+// regions)
+class RandomGenerator {
+  public:
+
+    RandomGenerator()
+    {
+	seed(0, 0, 0);
+    }
+
+    // (Re)starts the stream of the given component
+    void seed(const int global_seed, const int kind, const int id)
+    {
+	uint64_t x = (uint64_t) (uint32_t) global_seed;
+
+	x ^= mix64((((uint64_t) kind) << 32) | (uint32_t) id);
+	for (int i = 0; i < 4; i++)
+	{
+	    x += 0x9e3779b97f4a7c15ULL;	// splitmix64
+	    s[i] = (uint32_t) (mix64(x) >> 32);
+	}
+
+	// the all-zero state is the only one to be avoided
+	if ((s[0] | s[1] | s[2] | s[3]) == 0)
+	    s[0] = 1;
+    }
+
+    // Uniform in [0, 2^32 - 1]
+    uint32_t next()
+    {
+	const uint32_t result = rotl(s[1] * 5, 7) * 9;
+	const uint32_t t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 11);
+
+	return result;
+    }
+
+    // Uniform in [0, n - 1], without divisions
+    unsigned int below(const unsigned int n)
+    {
+	return (unsigned int) (((uint64_t) next() * n) >> 32);
+    }
+
+    // Uniform in [0, 1[
+    double uniform()
+    {
+	return next() * (1.0 / 4294967296.0);
+    }
+
+  private:
+
+    static uint32_t rotl(const uint32_t x, const int k)
+    {
+	return (x << k) | (x >> (32 - k));
+    }
+
+    static uint64_t mix64(uint64_t z)
+    {
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+    }
+
+    uint32_t s[4];
+};
+
+#endif
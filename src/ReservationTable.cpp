@@ -12,76 +12,106 @@
 
 ReservationTable::ReservationTable()
 {
+    n_inputs = 0;
+    n_outputs = 0;
+    n_words = 0;
 }
 
-void ReservationTable::setSize(const int n_outputs)
+void ReservationTable::setSize(const int n_inputs, const int n_outputs)
 {
+    this->n_inputs = n_inputs;
     this->n_outputs = n_outputs;
-    rtable = new TRTEntry[this->n_outputs];
+    n_words = (n_outputs + 63) / 64;
 
-    for (int i=0;i<this->n_outputs;i++)
+    rtable.resize(n_outputs);
+    for (int i=0;i<n_outputs;i++)
     {
+	rtable[i].size = 0;
 	rtable[i].index = 0;
-	rtable[i].reservations.clear();
+	for (int vc=0;vc<MAX_VIRTUAL_CHANNELS;vc++)
+	    rtable[i].vc_input[vc] = NOT_RESERVED;
     }
+
+    reserved_output.assign(n_inputs * MAX_VIRTUAL_CHANNELS, NOT_RESERVED);
+    head_outputs.assign(n_inputs * n_words, 0);
 }
 
-bool ReservationTable::isNotReserved(const int port_out)
+bool ReservationTable::isNotReserved(const int port_out) const
 {
     assert(port_out<n_outputs);
-    return (rtable[port_out].reservations.size()==0);
+    return (rtable[port_out].size==0);
+}
+
+int ReservationTable::headInput(const int port_out) const
+{
+    const TRTEntry & entry = rtable[port_out];
+
+    return (entry.size > 0) ? entry.reservations[entry.index].input : NOT_VALID;
+}
+
+void ReservationTable::updateHead(const int port_out, const int previous_head)
+{
+    int head = headInput(port_out);
+
+    if (head == previous_head)
+	return;
+
+    uint64_t bit = ((uint64_t) 1) << (port_out % 64);
+
+    if (previous_head != NOT_VALID)
+	head_outputs[previous_head * n_words + port_out / 64] &= ~bit;
+    if (head != NOT_VALID)
+	head_outputs[head * n_words + port_out / 64] |= bit;
 }
 
 /* For a given input, returns the set of output/vc reserved from that input.
  * An index is required for each output entry, to avoid that multiple invokations
  * with different inputs returns the same output in the same clock cycle. */
-vector<pair<int,int> > ReservationTable::getReservations(const int port_in)
+void ReservationTable::getReservations(const int port_in, vector<pair<int,int> > & reservations) const
 {
-    vector<pair<int,int> > reservations;
+    assert(port_in < n_inputs);
+
+    reservations.clear();
 
-    for (int o = 0;o<n_outputs;o++)
+    for (int w = 0;w<n_words;w++)
     {
-	if (rtable[o].reservations.size()>0)
+	uint64_t outputs = head_outputs[port_in * n_words + w];
+
+	while (outputs != 0)
 	{
-	    int current_index = rtable[o].index;
-	    if (rtable[o].reservations[current_index].input == port_in)
-		reservations.push_back(pair<int,int>(o,rtable[o].reservations[current_index].vc));
+	    int o = w * 64 + __builtin_ctzll(outputs);
+	    const TRTEntry & entry = rtable[o];
+
+	    reservations.push_back(pair<int,int>(o,entry.reservations[entry.index].vc));
+	    outputs &= outputs - 1;
 	}
     }
-    return reservations;
 }
 
 int ReservationTable::checkReservation(const TReservation r, const int port_out)
 {
+    assert(r.input < n_inputs && port_out < n_outputs);
+
     /* Sanity Check for forbidden table status:
      * - same input/VC in a different output line */
-    for (int o=0;o<n_outputs;o++)
-    {
-	for (vector<TReservation>::size_type i=0;i<rtable[o].reservations.size(); i++)
-	{
-	    // In the current implementation this should never happen
-	    if (o!=port_out && rtable[o].reservations[i] == r)
-	    {
-		return RT_ALREADY_OTHER_OUT;
-	    }
-	}
-    }
-    
+    int reserved = reserved_output[r.input * MAX_VIRTUAL_CHANNELS + r.vc];
+
+    // In the current implementation this should never happen
+    if (reserved != NOT_RESERVED && reserved != port_out)
+	return RT_ALREADY_OTHER_OUT;
+
      /* On a given output entry, reservations must differ by VC
      *  Motivation: they will be interleaved cycle-by-cycle as index moves */
+    int vc_input = rtable[port_out].vc_input[r.vc];
+
+    // the reservation is already present
+    if (vc_input == r.input)
+	return RT_ALREADY_SAME;
+
+    // the same VC for that output has been reserved by another input
+    if (vc_input != NOT_RESERVED)
+	return RT_OUTVC_BUSY;
 
-     int n_reservations = rtable[port_out].reservations.size();
-    for (int i=0;i< n_reservations; i++)
-    {
-	// the reservation is already present
-	if (rtable[port_out].reservations[i] == r)
-	    return RT_ALREADY_SAME;
-
-	// the same VC for that output has been reserved by another input
-	if (rtable[port_out].reservations[i].input != r.input &&
-	    rtable[port_out].reservations[i].vc == r.vc)
-	    return RT_OUTVC_BUSY;
-    }
     return RT_AVAILABLE;
 }
 
@@ -90,7 +120,7 @@ void ReservationTable::print()
     for (int o=0;o<n_outputs;o++)
     {
 	cout << o << ": ";
-	for (vector<TReservation>::size_type i=0;i<rtable[o].reservations.size();i++)
+	for (unsigned int i=0;i<rtable[o].size;i++)
 	{
 	    cout << "<" << rtable[o].reservations[i].input << "," << rtable[o].reservations[i].vc << ">, ";
 	}
@@ -108,30 +138,44 @@ void ReservationTable::reserve(const TReservation r, const int port_out)
     // should be assured by ReservationTable users
     assert(checkReservation(r, port_out)==RT_AVAILABLE);
 
+    TRTEntry & entry = rtable[port_out];
+    int previous_head = headInput(port_out);
+
     // TODO: a better policy could insert in a specific position as far a possible
     // from the current index
-    rtable[port_out].reservations.push_back(r);
+    entry.reservations[entry.size++] = r;
+    entry.vc_input[r.vc] = r.input;
+    reserved_output[r.input * MAX_VIRTUAL_CHANNELS + r.vc] = port_out;
 
+    updateHead(port_out, previous_head);
 }
 
 void ReservationTable::release(const TReservation r, const int port_out)
 {
     assert(port_out < n_outputs);
 
-    for (vector<TReservation>::iterator i=rtable[port_out].reservations.begin(); 
-	    i != rtable[port_out].reservations.end(); i++)
+    TRTEntry & entry = rtable[port_out];
+
+    for (unsigned int i=0;i<entry.size;i++)
     {
-	if (*i == r)
+	if (entry.reservations[i] == r)
 	{
-	    rtable[port_out].reservations.erase(i);
-	    vector<TReservation>::size_type removed_index = i - rtable[port_out].reservations.begin();
+	    int previous_head = headInput(port_out);
+
+	    for (unsigned int j=i+1;j<entry.size;j++)
+		entry.reservations[j-1] = entry.reservations[j];
+	    entry.size--;
 
-	    if (removed_index < rtable[port_out].index)
-		rtable[port_out].index--;
+	    if (i < entry.index)
+		entry.index--;
 	    else
-		if (rtable[port_out].index >= rtable[port_out].reservations.size())
-		    rtable[port_out].index = 0;
+		if (entry.index >= entry.size)
+		    entry.index = 0;
 
+	    entry.vc_input[r.vc] = NOT_RESERVED;
+	    reserved_output[r.input * MAX_VIRTUAL_CHANNELS + r.vc] = NOT_RESERVED;
+
+	    updateHead(port_out, previous_head);
 	    return;
 	}
     }
@@ -142,9 +186,13 @@ void ReservationTable::updateIndex()
 {
     for (int o=0;o<n_outputs;o++)
     {
-	if (rtable[o].reservations.size()>0)
-	    rtable[o].index = (rtable[o].index+1)%(rtable[o].reservations.size());
+	// with a single reservation the head does not change
+	if (rtable[o].size>1)
+	{
+	    int previous_head = headInput(o);
+
+	    rtable[o].index = (rtable[o].index+1)%(rtable[o].size);
+	    updateHead(o, previous_head);
+	}
     }
 }
-
-
@@ -12,6 +12,7 @@
 #define __NOXIMRESERVATIONTABLE_H__
 
 #include <cassert>
+#include <stdint.h>
 #include "DataStructs.h"
 #include "Utils.h"
 
@@ -28,10 +29,13 @@ struct TReservation
     }
 };
 
+// Reservations of an output, at most one per VC
 typedef struct RTEntry
 {
-    vector<TReservation> reservations;
-    vector<TReservation>::size_type index;
+    TReservation reservations[MAX_VIRTUAL_CHANNELS];	// in order of reservation
+    unsigned int size;
+    unsigned int index;		// reservation having highest priority in the current cycle
+    int vc_input[MAX_VIRTUAL_CHANNELS];	// input which reserved each VC (NOT_RESERVED if none)
 } TRTEntry;
 
 class ReservationTable {
@@ -51,25 +55,39 @@ class ReservationTable {
     // Asserts if port_out is not reserved or not valid
     void release(const TReservation r, const int port_out);
 
-    // Returns the pairs of output port and virtual channel reserved by port_in
-    vector<pair<int,int> > getReservations(const int port_int);
+    // Fills reservations with the pairs of output port and virtual
+    // channel reserved by port_in (reusing its storage)
+    void getReservations(const int port_in, vector<pair<int,int> > & reservations) const;
 
     // update the index of the reservation having highest priority in the current cycle
     void updateIndex();
 
     // check whether port_out has no reservations
-    bool isNotReserved(const int port_out);
+    bool isNotReserved(const int port_out) const;
 
-    void setSize(const int n_outputs);
+    void setSize(const int n_inputs, const int n_outputs);
 
     void print();
 
   private:
 
-     TRTEntry *rtable;	// reservation vector: rtable[i] gives a RTEntry containing the set of input/VC 
+    // Input owning the reservation having highest priority on port_out
+    int headInput(const int port_out) const;
+
+    // Moves port_out from the head set of previous_head to the one of
+    // its current head input
+    void updateHead(const int port_out, const int previous_head);
+
+    vector<TRTEntry> rtable;	// reservation vector: rtable[i] gives a RTEntry containing the set of input/VC 
 			// which reserved output port
 
-     int n_outputs;
+    vector<int> reserved_output;	// reserved_output[input * MAX_VIRTUAL_CHANNELS + vc]
+    vector<uint64_t> head_outputs;	// bitset of the outputs whose head is the input,
+					// head_outputs[input * n_words + output / 64]
+
+    int n_inputs;
+    int n_outputs;
+    int n_words;
 };
 
 #endif
@@ -16,8 +16,13 @@ inline int toggleKthBit(int n, int k)
 	return (n ^ (1 << (k-1)));
 }
 
+// The selection strategy publishes the buffer levels left by the
+// previous cycle before the flits are moved. This is the order in which
+// the reference scheduler evaluated the two former SC_METHODs, now fixed
+// so that every kernel follows it
 void Router::process()
 {
+    perCycleUpdate();
     txProcess();
     rxProcess();
 }
@@ -34,6 +39,14 @@ void Router::rxProcess()
 	}
 	routed_flits = 0;
 	local_drained = 0;
+	for (int i = 0; i < DIRECTIONS + 2; i++) {
+	    forwarded_flits[i] = 0;
+	    vc_busy_refusals[i] = 0;
+	    full_buffer_cycles[i] = 0;
+	}
+	injected_flits = 0;
+	ejected_packets = 0;
+	ejected_delay = 0.0;
     } 
     else 
     { 
@@ -48,10 +61,11 @@ void Router::rxProcess()
 
 	    if (req_rx[i].read() == 1 - current_level_rx[i])
 	    { 
-		Flit received_flit = flit_rx[i].read();
+		const Flit & received_flit = flit_rx[i].read();
+		const PacketDescriptor & packet = received_flit.packet();
 		//LOG<<"request opposite to the current_level, reading flit "<<received_flit<<endl;
 
-		int vc = received_flit.vc_id;
+		int vc = packet.vc_id;
 
 		if (!buffer[i][vc].IsFull()) 
 		{
@@ -67,8 +81,21 @@ void Router::rxProcess()
 		    current_level_rx[i] = 1 - current_level_rx[i];
 
 		    // if a new flit is injected from local PE
-		    if (received_flit.src_id == local_id)
+		    if (packet.src_id == local_id)
 			power.networkInterface();
+
+		    if (GlobalParams::latency_breakdown && received_flit.flit_type == FLIT_TYPE_HEAD)
+		    {
+			PacketDescriptor & descriptor = received_flit.packet();
+			double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+			if (i == DIRECTION_LOCAL)
+			{
+			    descriptor.network_entry = now;
+			    descriptor.contention = 0.0;
+			}
+			descriptor.hop_arrival = now;
+		    }
 		}
 
 		else  // buffer full
@@ -100,7 +127,10 @@ void Router::txProcess()
 	{
 	  req_tx[i].write(0);
 	  current_level_tx[i] = 0;
+	  for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	      route_output[i][vc] = NOT_VALID;
 	}
+      rng.seed(GlobalParams::rnd_generator_seed, RANDOM_STREAM_ROUTER, local_id);
     } 
   else 
     { 
@@ -119,7 +149,7 @@ void Router::txProcess()
 
 	      if (!buffer[i][vc].IsEmpty()) 
 	      {
-		  Flit flit = buffer[i][vc].Front();
+		  const Flit & flit = buffer[i][vc].Front();
 		  power.bufferRouterFront();
 
 		  if (flit.flit_type == FLIT_TYPE_HEAD) 
@@ -128,21 +158,40 @@ void Router::txProcess()
 		      RouteData route_data;
 		      route_data.current_id = local_id;
 		      //LOG<< "current_id= "<< route_data.current_id <<" for sending " << flit << endl;
-		      route_data.src_id = flit.src_id;
-		      route_data.dst_id = flit.dst_id;
+		      const PacketDescriptor & packet = flit.packet();
+		      route_data.src_id = packet.src_id;
+		      route_data.dst_id = packet.dst_id;
 		      route_data.dir_in = i;
-		      route_data.vc_id = flit.vc_id;
+		      route_data.vc_id = packet.vc_id;
 
-		      // TODO: see PER POSTERI (adaptive routing should not recompute route if already reserved)
-		      int o = route(route_data);
+		      // With -route_timeout the output of a waiting head flit is
+		      // kept until reserved, or until it waited for route_timeout
+		      // cycles without obtaining the reservation
+		      int o;
+
+		      if (GlobalParams::route_timeout > 0 && route_output[i][vc] != NOT_VALID &&
+			  (route_reserved[i][vc] || route_age[i][vc] < GlobalParams::route_timeout))
+		      {
+			  o = route_output[i][vc];
+			  route_age[i][vc]++;
+		      }
+		      else
+		      {
+			  o = route(route_data);
+			  route_output[i][vc] = o;
+			  route_age[i][vc] = 1;
+			  route_reserved[i][vc] = false;
+		      }
 
 		      // manage special case of target hub not directly connected to destination
 		      if (o>=DIRECTION_HUB_RELAY)
 			  {
-		      	Flit f = buffer[i][vc].Pop();
-		      	f.hub_relay_node = o-DIRECTION_HUB_RELAY;
+		      	Flit f = flit;
+		      	buffer[i][vc].Pop();
+		      	f.packet().hub_relay_node = o-DIRECTION_HUB_RELAY;
 		      	buffer[i][vc].Push(f);
 		      	o = DIRECTION_HUB;
+		      	route_output[i][vc] = NOT_VALID;	// relay node is chosen again each time
 			  }
 
 		      TReservation r;
@@ -157,14 +206,17 @@ void Router::txProcess()
 		      {
 			  LOG << " reserving direction " << o << " for flit " << flit << endl;
 			  reservation_table.reserve(r, o);
+			  route_reserved[i][vc] = true;
 		      }
 		      else if (rt_status == RT_ALREADY_SAME)
 		      {
 			  LOG << " RT_ALREADY_SAME reserved direction " << o << " for flit " << flit << endl;
+			  route_reserved[i][vc] = true;
 		      }
 		      else if (rt_status == RT_OUTVC_BUSY)
 		      {
 			  LOG << " RT_OUTVC_BUSY reservation direction " << o << " for flit " << flit << endl;
+			  vc_busy_refusals[o]++;
 		      }
 		      else if (rt_status == RT_ALREADY_OTHER_OUT)
 		      {
@@ -183,12 +235,12 @@ void Router::txProcess()
       //if (local_id==6) LOG<<"*TX*****local_id="<<local_id<<"__ack_tx[0]= "<<ack_tx[0].read()<<endl;
       for (int i = 0; i < DIRECTIONS + 2; i++) 
       { 
-	  vector<pair<int,int> > reservations = reservation_table.getReservations(i);
+	  reservation_table.getReservations(i, reservations);
 	  
 	  if (reservations.size()!=0)
 	  {
 
-	      int rnd_idx = rand()%reservations.size();
+	      int rnd_idx = rng.below(reservations.size());
 
 	      int o = reservations[rnd_idx].first;
 	      int vc = reservations[rnd_idx].second;
@@ -197,7 +249,7 @@ void Router::txProcess()
 	      if (!buffer[i][vc].IsEmpty())  
 	      {
 		  // power contribution already computed in 1st phase
-		  Flit flit = buffer[i][vc].Front();
+		  const Flit & flit = buffer[i][vc].Front();
 		  //LOG<< "*****TX***Direction= "<<i<< "************"<<endl;
 		  //LOG<<"_cl_tx="<<current_level_tx[o]<<"req_tx="<<req_tx[o].read()<<" _ack= "<<ack_tx[o].read()<< endl;
 		  
@@ -210,7 +262,6 @@ void Router::txProcess()
 		      flit_tx[o].write(flit);
 		      current_level_tx[o] = 1 - current_level_tx[o];
 		      req_tx[o].write(current_level_tx[o]);
-		      buffer[i][vc].Pop();
 
 		      if (flit.flit_type == FLIT_TYPE_TAIL)
 		      {
@@ -220,6 +271,9 @@ void Router::txProcess()
 			  reservation_table.release(r,o);
 		      }
 
+		      if (flit.flit_type == FLIT_TYPE_HEAD)
+			  route_output[i][vc] = NOT_VALID;
+
 		      /* Power & Stats ------------------------------------------------- */
 		      if (o == DIRECTION_HUB) power.r2hLink();
 		      else
@@ -228,11 +282,33 @@ void Router::txProcess()
 		      power.bufferRouterPop();
 		      power.crossBar();
 
+		      forwarded_flits[o]++;
+		      if (i == DIRECTION_LOCAL)
+			  injected_flits++;
+
+		      // a head flit stored at a cycle is forwarded at the next
+		      // one at the earliest (txProcess precedes rxProcess)
+		      if (GlobalParams::latency_breakdown && flit.flit_type == FLIT_TYPE_HEAD)
+		      {
+			  PacketDescriptor & descriptor = flit.packet();
+			  double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+			  descriptor.contention += now - descriptor.hop_arrival - 1;
+			  descriptor.hop_no++;
+		      }
+
 		      if (o == DIRECTION_LOCAL) 
 		      {
+			  double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
 			  power.networkInterface();
 			  LOG << "Consumed flit " << flit << endl;
-			  stats.receivedFlit(sc_time_stamp().to_double() / GlobalParams::clock_period_ps, flit);
+			  stats.receivedFlit(now, flit);
+			  if (flit.flit_type == FLIT_TYPE_HEAD)
+			  {
+			      ejected_packets++;
+			      ejected_delay += now - flit.packet().timestamp;
+			  }
 			  if (GlobalParams:: max_volume_to_be_drained) 
 			  {
 			      if (drained_volume >= GlobalParams:: max_volume_to_be_drained)
@@ -247,6 +323,9 @@ void Router::txProcess()
 		      else if (i != DIRECTION_LOCAL) // not generated locally
 			  routed_flits++;
 		      /* End Power & Stats ------------------------------------------------- */
+
+		      // flit refers to the buffer, it is released last
+		      buffer[i][vc].Pop();
 			 //LOG<<"END_OK_cl_tx="<<current_level_tx[o]<<"_req_tx="<<req_tx[o].read()<<" _ack= "<<ack_tx[o].read()<< endl;
 		  }
 		  else
@@ -254,6 +333,7 @@ void Router::txProcess()
 		      LOG << " Cannot forward Input[" << i << "][" << vc << "] to Output[" << o << "], flit: " << flit << endl;
 		      //LOG << " **DEBUG APB: current_level_tx: " << current_level_tx[o] << " ack_tx: " << ack_tx[o].read() << endl;
 		      LOG << " **DEBUG buffer_full_status_tx " << buffer_full_status_tx[o].read().mask[vc] << endl;
+		      full_buffer_cycles[o]++;
 
 		  	//LOG<<"END_NO_cl_tx="<<current_level_tx[o]<<"_req_tx="<<req_tx[o].read()<<" _ack= "<<ack_tx[o].read()<< endl;
 		      /*
@@ -300,17 +380,97 @@ void Router::perCycleUpdate()
     } else {
         selectionStrategy->perCycleUpdate(this);
 
-	power.leakageRouter();
-	for (int i = 0; i < DIRECTIONS + 1; i++)
+	accountLeakage(1);
+    }
+}
+
+void Router::accountLeakage(const unsigned int cycles)
+{
+    power.leakageRouter(cycles);
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+    {
+	for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
 	{
-	    for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
-	    {
-		power.leakageBufferRouter();
-		power.leakageLinkRouter2Router();
-	    }
+	    power.leakageBufferRouter(cycles);
+	    power.leakageLinkRouter2Router(cycles);
 	}
+    }
 
-	power.leakageLinkRouter2Hub();
+    power.leakageLinkRouter2Hub(cycles);
+}
+
+void Router::end_of_elaboration()
+{
+    if (!GlobalParams::fast_kernel)
+	return;
+
+    // An idle router only reacts to incoming flits (req_rx) and, through
+    // the selection strategy, to the free slots of its neighbors: any
+    // other input is only read while there are flits to forward
+    can_sleep = true;
+    for (int i = 0; i < DIRECTIONS + 2; i++)
+	can_sleep = wakeupOnChange(req_rx[i], wakeup) && can_sleep;
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+	can_sleep = wakeupOnChange(free_slots_neighbor[i], wakeup) && can_sleep;
+}
+
+bool Router::isIdle()
+{
+    for (int i = 0; i < DIRECTIONS + 2; i++)
+    {
+	if (!reservation_table.isNotReserved(i))
+	    return false;
+
+	for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+	    if (!buffer[i][vc].IsEmpty())
+		return false;
+    }
+
+    return true;
+}
+
+// Brings an idle router to the state it would have reached if evaluated
+// for the given number of cycles: only the arbitration indexes and the
+// leakage change, as outputs are rewritten with the same values
+void Router::skipCycles(const unsigned int cycles)
+{
+    start_from_port = (start_from_port + cycles) % (DIRECTIONS + 2);
+    for (int i = 0; i < DIRECTIONS + 2; i++)
+	start_from_vc[i] = (start_from_vc[i] + cycles) % GlobalParams::n_virtual_channels;
+
+    accountLeakage(cycles);
+}
+
+void Router::accountSleep(const unsigned long cycle)
+{
+    if (sleeping)
+    {
+	skipCycles(cycle - sleep_cycle);
+	sleep_cycle = cycle;
+    }
+}
+
+void Router::fastKernelProcess(const unsigned long cycle)
+{
+    if (reset.read())
+	sleeping = false;
+    else if (sleeping)
+    {
+	if (!wakeup)
+	    return;
+
+	accountSleep(cycle);
+	sleeping = false;
+    }
+
+    wakeup = false;
+
+    process();
+
+    if (can_sleep && !reset.read() && isIdle())
+    {
+	sleeping = true;
+	sleep_cycle = cycle + 1;
     }
 }
 
@@ -326,7 +486,7 @@ vector<int> Router::nextDeltaHops(RouteData rd) {
 	int dst = rd.dst_id;
 
 	int current_node = src;
-	vector<int> direction; // initially is empty
+	DirectionSet direction; // initially is empty
 	vector<int> next_hops;
 
 	int sw = GlobalParams::n_delta_tiles/2; //sw: switch number in each stage
@@ -389,7 +549,7 @@ vector<int> Router::nextDeltaHops(RouteData rd) {
 
 }
 
-vector < int > Router::routingFunction(const RouteData & route_data)
+DirectionSet Router::routingFunction(const RouteData & route_data)
 {
 	if (GlobalParams::use_winoc)
 	{
@@ -414,7 +574,7 @@ vector < int > Router::routingFunction(const RouteData & route_data)
                 if (connectedHubs(it1->second,it2->second))
                 {
                     LOG << "Destination node " << route_data.dst_id << " is directly connected to a reachable RadioHub" << endl;
-                    vector<int> dirv;
+                    DirectionSet dirv;
                     dirv.push_back(DIRECTION_HUB);
                     return dirv;
                 }
@@ -435,7 +595,7 @@ vector < int > Router::routingFunction(const RouteData & route_data)
 					if ( hasRadioHub(candidate_hop) && !sameRadioHub(local_id,candidate_hop) ) {
 						//LOG << "Checking candidate hop " << candidate_hop << " ... It's OK!" << endl;
 						LOG << "Relaying to hub-connected node " << candidate_hop << " to reach destination " << route_data.dst_id << endl;
-						vector<int> dirv;
+						DirectionSet dirv;
 						dirv.push_back(DIRECTION_HUB_RELAY+candidate_hop);
 						return dirv;
 					}
@@ -450,9 +610,84 @@ vector < int > Router::routingFunction(const RouteData & route_data)
 		LOG << "Wired routing for dst = " << route_data.dst_id << endl;
 
 	// not wireless direction taken, apply normal routing
+	if (route_data.current_id == local_id && !route_lut.empty())
+	{
+	    int i = routeLUTIndex(route_data.dst_id);
+
+	    assert(route_lut[i] != PACKED_DIRECTIONS_NOT_VALID);
+
+	    return DirectionSet::unpack(route_lut[i]);
+	}
+
 	return routingAlgorithm->route(this, route_data);
 }
 
+void Router::buildRouteLUT()
+{
+    route_lut.clear();
+    route_lut_mesh = false;
+    route_lut_side_x.clear();
+    route_lut_side_y.clear();
+
+    // adaptive algorithms, and those depending on the source or on the
+    // input direction, are evaluated at each routing decision
+    if (!routingAlgorithm->isPrecomputable())
+	return;
+
+    RouteData route_data;
+    route_data.current_id = local_id;
+    route_data.src_id = NOT_VALID;
+    route_data.dir_in = NOT_VALID;
+    route_data.vc_id = NOT_VALID;
+
+    // on the mesh the nearest node on each side stands for all the
+    // destinations on that side, whatever the size of the mesh
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	Coord current = id2Coord(local_id);
+
+	// the side of a destination is looked up by its column and row
+	route_lut_mesh = true;
+	for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+	    route_lut_side_x.push_back((x > current.x) - (x < current.x) + 1);
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    route_lut_side_y.push_back((y > current.y) - (y < current.y) + 1);
+
+	route_lut.assign(9, PACKED_DIRECTIONS_NOT_VALID);
+
+	for (int dx = -1; dx <= 1; dx++)
+	    for (int dy = -1; dy <= 1; dy++)
+	    {
+		Coord dst;
+		dst.x = current.x + dx;
+		dst.y = current.y + dy;
+
+		// the packets for the local PE are not routed (see route())
+		if ((dx == 0 && dy == 0) ||
+		    dst.x < 0 || dst.x >= GlobalParams::mesh_dim_x ||
+		    dst.y < 0 || dst.y >= GlobalParams::mesh_dim_y)
+		    continue;
+
+		route_data.dst_id = coord2Id(dst);
+		route_lut[routeLUTIndex(route_data.dst_id)] = routingAlgorithm->route(this, route_data).pack();
+	    }
+
+	return;
+    }
+
+    // a table per destination is too large for big delta networks
+    if (GlobalParams::n_delta_tiles > ROUTE_LUT_MAX_DESTINATIONS)
+	return;
+
+    route_lut.assign(GlobalParams::n_delta_tiles, PACKED_DIRECTIONS_NOT_VALID);
+
+    for (int dst = 0; dst < GlobalParams::n_delta_tiles; dst++)
+    {
+	route_data.dst_id = dst;
+	route_lut[dst] = routingAlgorithm->route(this, route_data).pack();
+    }
+}
+
 int Router::route(const RouteData & route_data)
 {
 
@@ -460,7 +695,7 @@ int Router::route(const RouteData & route_data)
 	return DIRECTION_LOCAL;
 
     power.routing();
-    vector < int >candidate_channels = routingFunction(route_data);
+    DirectionSet candidate_channels = routingFunction(route_data);
 
     power.selection();
     return selectionFunction(candidate_channels, route_data);
@@ -481,7 +716,7 @@ void Router::NoP_report() const
 //---------------------------------------------------------------------------
 
 int Router::NoPScore(const NoP_data & nop_data,
-			  const vector < int >&nop_channels) const
+			  const DirectionSet & nop_channels) const
 {
     int score = 0;
 
@@ -502,7 +737,7 @@ int Router::NoPScore(const NoP_data & nop_data,
     return score;
 }
 
-int Router::selectionFunction(const vector < int >&directions,
+int Router::selectionFunction(const DirectionSet & directions,
 				   const RouteData & route_data)
 {
     // not so elegant but fast escape ;)
@@ -526,13 +761,23 @@ void Router::configure(const int _id,
     if (grt.isValid())
 	routing_table.configure(grt, _id);
 
-    reservation_table.setSize(DIRECTIONS+2);
+    buildRouteLUT();
+
+    reservation_table.setSize(DIRECTIONS+2, DIRECTIONS+2);
+
+    // the rings of the virtual channels in use are contiguous
+    unsigned int ring_capacity = Buffer::RingCapacity(_max_buffer_size);
+
+    buffer_arena.assign((DIRECTIONS + 2) * GlobalParams::n_virtual_channels * ring_capacity, Flit());
 
     for (int i = 0; i < DIRECTIONS + 2; i++)
     {
 	for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
 	{
+	    Flit * ring = &buffer_arena[(i * GlobalParams::n_virtual_channels + vc) * ring_capacity];
+
 	    buffer[i][vc].SetMaxBufferSize(_max_buffer_size);
+	    buffer[i][vc].SetStorage(ring, ring_capacity);
 	    buffer[i][vc].setLabel(string(name())+"->buffer["+i_to_string(i)+"]");
 	}
 	start_from_vc[i] = 0;
@@ -19,6 +19,8 @@
 #include "LocalRoutingTable.h"
 #include "ReservationTable.h"
 #include "Utils.h"
+#include "FastSignal.h"
+#include "Random.h"
 #include "routingAlgorithms/RoutingAlgorithm.h"
 #include "routingAlgorithms/RoutingAlgorithms.h"
 #include "selectionStrategies/SelectionStrategy.h"
@@ -26,6 +28,9 @@
 #include "selectionStrategies/Selection_NOP.h"
 #include "selectionStrategies/Selection_BUFFER_LEVEL.h"
 
+// Delta networks with more tiles evaluate the routing at each decision
+#define ROUTE_LUT_MAX_DESTINATIONS	4096
+
 using namespace std;
 
 extern unsigned int drained_volume;
@@ -63,22 +68,45 @@ SC_MODULE(Router)
     int routing_type;		                // Type of routing algorithm
     int selection_type;
     BufferBank buffer[DIRECTIONS + 2];		// buffer[direction][virtual_channel] 
+    vector < Flit > buffer_arena;		// Rings of all the buffers in use
     bool current_level_rx[DIRECTIONS + 2];	// Current level for Alternating Bit Protocol (ABP)
     bool current_level_tx[DIRECTIONS + 2];	// Current level for Alternating Bit Protocol (ABP)
     Stats stats;		                // Statistics
     Power power;
+    RandomGenerator rng;			// Private random stream
     LocalRoutingTable routing_table;		// Routing table
+    vector < unsigned int > route_lut;		// Packed candidates (see buildRouteLUT)
+    bool route_lut_mesh;			// route_lut indexed by side instead of destination
+    vector < unsigned char > route_lut_side_x;	// Side of each column: 0 west, 1 same, 2 east (mesh)
+    vector < unsigned char > route_lut_side_y;	// Side of each row: 0 north, 1 same, 2 south (mesh)
     ReservationTable reservation_table;		// Switch reservation table
+    vector < pair <int,int> > reservations;	// Reservations of an input, reused at each cycle
     unsigned long routed_flits;
+
+    // Activity counters (see Telemetry and GlobalStats::saveHeatmaps)
+    unsigned long forwarded_flits[DIRECTIONS + 2];	// Flits sent on each output port
+    unsigned long vc_busy_refusals[DIRECTIONS + 2];	// Head flits refused by each output, VC reserved, once per cycle
+    unsigned long full_buffer_cycles[DIRECTIONS + 2];	// Reserved flits held by each output, downstream not ready
+    unsigned long injected_flits;	// Flits coming from the local PE
+    unsigned long ejected_packets;	// Packets delivered to the local PE
+    double ejected_delay;		// Sum of the delays of the ejected packets
     RoutingAlgorithm * routingAlgorithm; 
     SelectionStrategy * selectionStrategy; 
+
+    // Activity-driven evaluation (fast kernel only)
+    FastSignalWakeup wakeup;			// Raised when a relevant input changes
+    bool can_sleep;				// All the relevant inputs can raise wakeup
+    bool sleeping;				// Idle, not evaluated until woken up
+    unsigned long sleep_cycle;			// First kernel cycle not evaluated
     
     // Functions
 
-    void process();
+    void process();		// perCycleUpdate(), txProcess() and rxProcess()
     void rxProcess();		// The receiving process
     void txProcess();		// The transmitting process
     void perCycleUpdate();
+    void fastKernelProcess(const unsigned long cycle);	// process() unless sleeping
+    void accountSleep(const unsigned long cycle);	// Accounts the cycles slept before cycle
     void configure(const int _id, const double _warm_up_time,
 		   const unsigned int _max_buffer_size,
 		   GlobalRoutingTable & grt);
@@ -88,13 +116,26 @@ SC_MODULE(Router)
     // Constructor
 
     SC_CTOR(Router) {
-        SC_METHOD(process);
-        sensitive << reset;
-        sensitive << clock.pos();
+        wakeup = false;
+        can_sleep = false;
+        sleeping = false;
+        sleep_cycle = 0;
+        route_lut_mesh = false;
+
+        // the processes are evaluated once before the reset
+        for (int i = 0; i < DIRECTIONS + 2; i++)
+        {
+            current_level_rx[i] = 0;
+            current_level_tx[i] = 0;
+        }
 
-        SC_METHOD(perCycleUpdate);
-        sensitive << reset;
-        sensitive << clock.pos();
+        // with the fast kernel the process is driven by NoC
+        if (!GlobalParams::fast_kernel)
+        {
+            SC_METHOD(process);
+            sensitive << reset;
+            sensitive << clock.pos();
+        }
 
         routingAlgorithm = RoutingAlgorithms::get(GlobalParams::routing_algorithm);
 
@@ -113,26 +154,49 @@ SC_MODULE(Router)
         }
     }
 
+  protected:
+
+    void end_of_elaboration();
+
   private:
 
     // performs actual routing + selection
     int route(const RouteData & route_data);
 
     // wrappers
-    int selectionFunction(const vector <int> &directions,
+    int selectionFunction(const DirectionSet & directions,
 			  const RouteData & route_data);
-    vector < int >routingFunction(const RouteData & route_data);
+    DirectionSet routingFunction(const RouteData & route_data);
+    void buildRouteLUT();	// Precomputes the candidates of precomputable routing algorithms
+
+    // Entry of route_lut for a destination
+    int routeLUTIndex(const int dst_id) const
+    {
+	if (!route_lut_mesh)
+	    return dst_id;
+
+	return route_lut_side_x[dst_id % GlobalParams::mesh_dim_x] * 3 +
+	       route_lut_side_y[dst_id / GlobalParams::mesh_dim_x];
+    }
  
     NoP_data getCurrentNoPData();
     void NoP_report() const;
-    int NoPScore(const NoP_data & nop_data, const vector <int> & nop_channels) const;
+    int NoPScore(const NoP_data & nop_data, const DirectionSet & nop_channels) const;
     int reflexDirection(int direction) const;
+    bool isIdle();
+    void skipCycles(const unsigned int cycles);
+    void accountLeakage(const unsigned int cycles);
     int getNeighborId(int _id, int direction) const;
    
     vector<int> getNextHops(int src, int dst);
     int start_from_port;	     // Port from which to start the reservation cycle
     int start_from_vc[DIRECTIONS+2]; // VC from which to start the reservation cycle for the specific port
 
+    // Route of the head flit waiting in each input VC (see -route_timeout)
+    int route_output[DIRECTIONS + 2][MAX_VIRTUAL_CHANNELS];	// NOT_VALID if to be computed
+    int route_age[DIRECTIONS + 2][MAX_VIRTUAL_CHANNELS];	// Cycles since the route was computed
+    bool route_reserved[DIRECTIONS + 2][MAX_VIRTUAL_CHANNELS];	// The output has been reserved
+
     vector<int> nextDeltaHops(RouteData rd);
   public:
     unsigned int local_drained;
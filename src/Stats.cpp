@@ -12,6 +12,145 @@
 
 // TODO: nan in averageDelay
 
+unsigned int DelayHistogram::bucket(const double delay)
+{
+    unsigned long d = (delay > 0.0) ? (unsigned long) delay : 0;
+
+    if (d < DELAY_HISTOGRAM_LINEAR)
+	return d;
+
+    // the leading bit gives the power of two, the following ones the
+    // bucket within it
+    int msb = 0;
+    while ((d >> (msb + 1)) != 0)
+	msb++;
+
+    int shift = msb - DELAY_HISTOGRAM_SUB_BITS;
+    unsigned int sub_bucket = (d >> shift) - DELAY_HISTOGRAM_SUB_BUCKETS;
+
+    return DELAY_HISTOGRAM_LINEAR + (shift - 1) * DELAY_HISTOGRAM_SUB_BUCKETS + sub_bucket;
+}
+
+double DelayHistogram::bucketUpperBound(const unsigned int b)
+{
+    if (b < DELAY_HISTOGRAM_LINEAR)
+	return b;
+
+    int shift = (b - DELAY_HISTOGRAM_LINEAR) / DELAY_HISTOGRAM_SUB_BUCKETS + 1;
+    unsigned long sub_bucket = (b - DELAY_HISTOGRAM_LINEAR) % DELAY_HISTOGRAM_SUB_BUCKETS;
+
+    return (double) (((DELAY_HISTOGRAM_SUB_BUCKETS + sub_bucket + 1) << shift) - 1);
+}
+
+void DelayHistogram::add(const double delay)
+{
+    unsigned int b = bucket(delay);
+
+    if (b >= counts.size())
+	counts.resize(b + 1, 0);
+
+    counts[b]++;
+}
+
+void DelayHistogram::merge(const DelayHistogram & histogram)
+{
+    if (histogram.counts.size() > counts.size())
+	counts.resize(histogram.counts.size(), 0);
+
+    for (unsigned int b = 0; b < histogram.counts.size(); b++)
+	counts[b] += histogram.counts[b];
+}
+
+double DelayHistogram::getPercentile(const double q) const
+{
+    unsigned long samples = 0;
+
+    for (unsigned int b = 0; b < counts.size(); b++)
+	samples += counts[b];
+
+    if (samples == 0)
+	return -1.0;
+
+    unsigned long rank = (unsigned long) ceil(q * samples);
+    if (rank == 0)
+	rank = 1;
+
+    unsigned long seen = 0;
+
+    for (unsigned int b = 0; b < counts.size(); b++)
+    {
+	seen += counts[b];
+	if (seen >= rank)
+	    return bucketUpperBound(b);
+    }
+
+    return bucketUpperBound(counts.size() - 1);
+}
+
+// Welford's update of the squared deviations
+void DelayStats::add(const double delay)
+{
+    double old_mean = count ? sum / count : 0.0;
+
+    count++;
+    sum += delay;
+    m2 += (delay - old_mean) * (delay - sum / count);
+    if (delay > max)
+	max = delay;
+    histogram.add(delay);
+}
+
+// Chan's combination of the squared deviations of two sets of samples
+void DelayStats::merge(const DelayStats & delays)
+{
+    if (delays.count == 0)
+	return;
+
+    if (count)
+    {
+	double diff = delays.getMean() - getMean();
+	double n = (double) count * delays.count / (count + delays.count);
+
+	m2 += delays.m2 + diff * diff * n;
+    }
+    else
+	m2 = delays.m2;
+
+    count += delays.count;
+    sum += delays.sum;
+    if (delays.max > max)
+	max = delays.max;
+    histogram.merge(delays.histogram);
+}
+
+void LatencyBreakdown::add(const PacketDescriptor & packet, const double tail_ejection)
+{
+    double network = packet.head_ejection - packet.network_entry;
+
+    count++;
+    hops += packet.hop_no;
+    queueing += packet.network_entry - packet.timestamp;
+    transport += network - packet.contention;
+    contention += packet.contention;
+    serialization += tail_ejection - packet.head_ejection;
+}
+
+void LatencyBreakdown::merge(const LatencyBreakdown & latency)
+{
+    count += latency.count;
+    hops += latency.hops;
+    queueing += latency.queueing;
+    transport += latency.transport;
+    contention += latency.contention;
+    serialization += latency.serialization;
+}
+
+// The bucket bound is not reported beyond the largest delay
+double DelayStats::getPercentile(const double q) const
+{
+    return min(histogram.getPercentile(q), max);
+}
+
 void Stats::configure(const int node_id, const double _warm_up_time)
 {
     id = node_id;
@@ -21,25 +160,40 @@ void Stats::configure(const int node_id, const double _warm_up_time)
 void Stats::receivedFlit(const double arrival_time,
 			      const Flit & flit)
 {
+    // the head is time stamped even in the warm-up, the packet being
+    // accounted with the tail
+    if (GlobalParams::latency_breakdown && flit.flit_type == FLIT_TYPE_HEAD)
+	flit.packet().head_ejection = arrival_time;
+
     if (arrival_time - GlobalParams::reset_time < warm_up_time)
 	return;
 
-    int i = searchCommHistory(flit.src_id);
+    const PacketDescriptor & packet = flit.packet();
+    int i = searchCommHistory(packet.src_id);
 
     if (i == -1) {
 	// first flit received from a given source
 	// initialize CommHist structure
 	CommHistory ch;
 
-	ch.src_id = flit.src_id;
+	ch.src_id = packet.src_id;
 	ch.total_received_flits = 0;
 	chist.push_back(ch);
 
 	i = chist.size() - 1;
+	if (packet.src_id >= (int) chist_index.size())
+	    chist_index.resize(packet.src_id + 1, -1);
+	chist_index[packet.src_id] = i;
     }
 
     if (flit.flit_type == FLIT_TYPE_HEAD)
-	chist[i].delays.push_back(arrival_time - flit.timestamp);
+	chist[i].delays.add(arrival_time - packet.timestamp);
+
+    // only the packets whose delay is accounted (head after the warm-up)
+    if (GlobalParams::latency_breakdown &&
+	(flit.flit_type == FLIT_TYPE_TAIL || packet.sequence_length == 1) &&
+	packet.head_ejection - GlobalParams::reset_time >= warm_up_time)
+	chist[i].latency.add(packet, arrival_time);
 
     chist[i].total_received_flits++;
     chist[i].last_received_flit_time = arrival_time - warm_up_time;
@@ -47,16 +201,11 @@ void Stats::receivedFlit(const double arrival_time,
 
 double Stats::getAverageDelay(const int src_id)
 {
-    double sum = 0.0;
-
     int i = searchCommHistory(src_id);
 
     assert(i >= 0);
 
-    for (unsigned int j = 0; j < chist[i].delays.size(); j++)
-	sum += chist[i].delays[j];
-
-    return sum / (double) chist[i].delays.size();
+    return chist[i].delays.getMean();
 }
 
 double Stats::getAverageDelay()
@@ -64,7 +213,7 @@ double Stats::getAverageDelay()
     double avg = 0.0;
 
     for (unsigned int k = 0; k < chist.size(); k++) {
-	unsigned int samples = chist[k].delays.size();
+	unsigned int samples = chist[k].delays.count;
 	if (samples)
 	    avg += (double) samples *getAverageDelay(chist[k].src_id);
     }
@@ -74,17 +223,11 @@ double Stats::getAverageDelay()
 
 double Stats::getMaxDelay(const int src_id)
 {
-    double maxd = -1.0;
-
     int i = searchCommHistory(src_id);
 
     assert(i >= 0);
 
-    for (unsigned int j = 0; j < chist[i].delays.size(); j++)
-	if (chist[i].delays[j] > maxd) {
-	    maxd = chist[i].delays[j];
-	}
-    return maxd;
+    return chist[i].delays.max;
 }
 
 double Stats::getMaxDelay()
@@ -92,7 +235,7 @@ double Stats::getMaxDelay()
     double maxd = -1.0;
 
     for (unsigned int k = 0; k < chist.size(); k++) {
-	unsigned int samples = chist[k].delays.size();
+	unsigned int samples = chist[k].delays.count;
 	if (samples) {
 	    double m = getMaxDelay(chist[k].src_id);
 	    if (m > maxd)
@@ -134,12 +277,24 @@ double Stats::getAverageThroughput()
     return sum;
 }
 
+void Stats::collectDelays(DelayStats & delays) const
+{
+    for (unsigned int i = 0; i < chist.size(); i++)
+	delays.merge(chist[i].delays);
+}
+
+void Stats::collectLatencyBreakdown(LatencyBreakdown & latency) const
+{
+    for (unsigned int i = 0; i < chist.size(); i++)
+	latency.merge(chist[i].latency);
+}
+
 unsigned int Stats::getReceivedPackets()
 {
     int n = 0;
 
     for (unsigned int i = 0; i < chist.size(); i++)
-	n += chist[i].delays.size();
+	n += chist[i].delays.count;
 
     return n;
 }
@@ -185,11 +340,10 @@ double Stats::getCommunicationEnergy(int src_id, int dst_id)
 
 int Stats::searchCommHistory(int src_id)
 {
-    for (unsigned int i = 0; i < chist.size(); i++)
-	if (chist[i].src_id == src_id)
-	    return i;
+    if (src_id < 0 || src_id >= (int) chist_index.size())
+	return -1;
 
-    return -1;
+    return chist_index[src_id];
 }
 
 void Stats::showStats(int curr_node, std::ostream & out, bool header)
@@ -221,7 +375,7 @@ void Stats::showStats(int curr_node, std::ostream & out, bool header)
 	    << setw(15) << getAverageThroughput(chist[i].src_id)
 	    << setw(13) << getCommunicationEnergy(chist[i].src_id,
 						  curr_node)
-	    << setw(12) << chist[i].delays.size()
+	    << setw(12) << chist[i].delays.count
 	    << setw(12) << chist[i].total_received_flits << endl;
     }
 
@@ -230,3 +384,43 @@ void Stats::showStats(int curr_node, std::ostream & out, bool header)
     out << "% Aggregated average throughput (flits/cycle): " <<
 	getAverageThroughput() << endl;
 }
+
+void Stats::showLatencyBreakdown(int curr_node, std::ostream & out, bool header)
+{
+    if (header) {
+	out << "%"
+	    << setw(5) << "src"
+	    << setw(5) << "dst"
+	    << setw(10) << "packets"
+	    << setw(10) << "hops"
+	    << setw(10) << "queueing"
+	    << setw(10) << "transport"
+	    << setw(11) << "contention"
+	    << setw(14) << "serialization" << endl;
+	out << "%"
+	    << setw(5) << ""
+	    << setw(5) << ""
+	    << setw(10) << ""
+	    << setw(10) << "avg"
+	    << setw(10) << "cycles"
+	    << setw(10) << "cycles"
+	    << setw(11) << "cycles"
+	    << setw(14) << "cycles" << endl;
+    }
+    for (unsigned int i = 0; i < chist.size(); i++) {
+	const LatencyBreakdown & latency = chist[i].latency;
+
+	if (latency.count == 0)
+	    continue;
+
+	out << " "
+	    << setw(5) << chist[i].src_id
+	    << setw(5) << curr_node
+	    << setw(10) << latency.count
+	    << setw(10) << (double) latency.hops / latency.count
+	    << setw(10) << latency.queueing / latency.count
+	    << setw(10) << latency.transport / latency.count
+	    << setw(11) << latency.contention / latency.count
+	    << setw(14) << latency.serialization / latency.count << endl;
+    }
+}
@@ -18,9 +18,80 @@
 #include "Power.h"
 using namespace std;
 
+// DelayHistogram -- histogram of the delays (cycles) with logarithmic
+// buckets: one per cycle below DELAY_HISTOGRAM_LINEAR, then
+// DELAY_HISTOGRAM_SUB_BUCKETS per power of two, so that percentiles are
+// within 1/DELAY_HISTOGRAM_SUB_BUCKETS of the exact value. Buckets are
+// allocated up to the largest delay seen
+#define DELAY_HISTOGRAM_SUB_BITS	4
+#define DELAY_HISTOGRAM_SUB_BUCKETS	(1 << DELAY_HISTOGRAM_SUB_BITS)
+#define DELAY_HISTOGRAM_LINEAR		(2 * DELAY_HISTOGRAM_SUB_BUCKETS)
+
+class DelayHistogram {
+
+  public:
+
+    void add(const double delay);
+    void merge(const DelayHistogram & histogram);
+
+    // Smallest delay not exceeded by the fraction q of the samples, as
+    // the upper bound of its bucket
+    double getPercentile(const double q) const;
+
+  private:
+
+    static unsigned int bucket(const double delay);
+    static double bucketUpperBound(const unsigned int b);
+
+    vector < unsigned int > counts;
+};
+
+// DelayStats -- online statistics of the delays of the received packets.
+// Memory does not grow with the number of packets, and the statistics of
+// several communications can be merged
+struct DelayStats {
+    unsigned int count;
+    double sum;
+    double m2;			// Sum of the squared deviations from the mean
+    double max;			// -1 if no packets
+    DelayHistogram histogram;
+
+    DelayStats() : count(0), sum(0.0), m2(0.0), max(-1.0) { }
+
+    void add(const double delay);
+    void merge(const DelayStats & delays);
+
+    double getMean() const { return sum / count; }
+    double getVariance() const { return count ? m2 / count : 0.0; }
+    double getPercentile(const double q) const;
+};
+
+// LatencyBreakdown -- components of the latency of the received packets,
+// from their generation to the ejection of the tail flit (see
+// -latency_breakdown):
+// - queueing: in the PE queue, until the head enters the source router
+// - transport: from the source to the destination router, waits aside
+// - contention: waits of the head for an output or a downstream buffer
+// - serialization: from the ejection of the head to that of the tail
+struct LatencyBreakdown {
+    unsigned int count;
+    unsigned long hops;		// Routers traversed
+    double queueing;
+    double transport;
+    double contention;
+    double serialization;
+
+    LatencyBreakdown() : count(0), hops(0), queueing(0.0), transport(0.0),
+	contention(0.0), serialization(0.0) { }
+
+    void add(const PacketDescriptor & packet, const double tail_ejection);
+    void merge(const LatencyBreakdown & latency);
+};
+
 struct CommHistory {
     int src_id;
-     vector < double >delays;
+    DelayStats delays;
+    LatencyBreakdown latency;
     unsigned int total_received_flits;
     double last_received_flit_time;
 };
@@ -58,6 +129,18 @@ class Stats {
     // Returns the average throughput (flits/cycle) for the current node
     double getAverageThroughput();
 
+    // Merges the delays of the packets received by the current node
+    void collectDelays(DelayStats & delays) const;
+
+    // Communications whose destination is the current node
+    const vector < CommHistory > & getCommHistory() const {
+	return chist;
+    }
+
+    // Merges the latency breakdown of the packets received by the
+    // current node
+    void collectLatencyBreakdown(LatencyBreakdown & latency) const;
+
     // Returns the number of received packets from current node
     unsigned int getReceivedPackets();
 
@@ -78,11 +161,17 @@ class Stats {
     void showStats(int curr_node, std::ostream & out =
 		   std::cout, bool header = false);
 
+    // Shows the average latency breakdown of each communication whose
+    // destination is the current node
+    void showLatencyBreakdown(int curr_node, std::ostream & out =
+			      std::cout, bool header = false);
+
 
   private:
 
     int id;
     vector < CommHistory > chist;
+    vector < int > chist_index;	// Position in chist of each source, -1 if none
     double warm_up_time;
 
     int searchCommHistory(int src_id);
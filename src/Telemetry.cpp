@@ -0,0 +1,110 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the periodic telemetry
+ */
+
+#include "Telemetry.h"
+
+Telemetry::Telemetry(sc_module_name nm, NoC * _noc) : sc_module(nm)
+{
+    noc = _noc;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		routers.push_back(noc->t[x][y]->r);
+    }
+    else // other delta topologies
+    {
+	int stg = log2(GlobalParams::n_delta_tiles);
+	int sw = GlobalParams::n_delta_tiles/2; //sw: switch number in each stage
+
+	for (int y = 0; y < GlobalParams::n_delta_tiles; y++)
+	    routers.push_back(noc->core[y]->r);
+
+	for (int y = 0; y < sw; y++)
+	    for (int x = 0; x < stg; x++)
+		routers.push_back(noc->t[x][y]->r);
+    }
+
+    previous.resize(routers.size());
+    for (unsigned int i = 0; i < previous.size(); i++)
+	memset(&previous[i], 0, sizeof(RouterSample));
+
+    out.open(GlobalParams::telemetry_filename.c_str());
+    if (!out)
+    {
+	cerr << "Error: cannot write telemetry file " << GlobalParams::telemetry_filename << endl;
+	exit(1);
+    }
+
+    // flits forwarded on each link are given as utilization (flits/cycle)
+    out << "cycle,router,injected_flits,ejected_flits,ejected_packets,average_delay,"
+	<< "buffered_flits,north,east,south,west,hub,dynamic_energy" << endl;
+
+    SC_THREAD(process);
+}
+
+void Telemetry::process()
+{
+    sc_time period(GlobalParams::clock_period_ps, SC_PS);
+
+    wait(period * GlobalParams::reset_time + period / 2);
+
+    for (unsigned long cycle = GlobalParams::telemetry_interval; ; cycle += GlobalParams::telemetry_interval)
+    {
+	wait(period * GlobalParams::telemetry_interval);
+	sample(cycle);
+    }
+}
+
+void Telemetry::sample(const unsigned long cycle)
+{
+    // with the fast kernel the leakage of sleeping routers is accounted
+    // when they wake up, dynamic energy is always up to date
+    for (unsigned int i = 0; i < routers.size(); i++)
+    {
+	Router *r = routers[i];
+	RouterSample & p = previous[i];
+	RouterSample s;
+
+	for (int d = 0; d < DIRECTIONS + 2; d++)
+	    s.forwarded_flits[d] = r->forwarded_flits[d];
+	s.injected_flits = r->injected_flits;
+	s.ejected_packets = r->ejected_packets;
+	s.ejected_delay = r->ejected_delay;
+	s.dynamic_energy = r->power.getDynamicPower();
+
+	unsigned int buffered = 0;
+	for (int d = 0; d < DIRECTIONS + 2; d++)
+	    for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		buffered += r->buffer[d][vc].Size();
+
+	unsigned long packets = s.ejected_packets - p.ejected_packets;
+	double interval = GlobalParams::telemetry_interval;
+
+	out << cycle << "," << r->local_id
+	    << "," << s.injected_flits - p.injected_flits
+	    << "," << s.forwarded_flits[DIRECTION_LOCAL] - p.forwarded_flits[DIRECTION_LOCAL]
+	    << "," << packets << ",";
+	if (packets)
+	    out << (s.ejected_delay - p.ejected_delay) / packets;
+	out << "," << buffered;
+
+	int links[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST, DIRECTION_HUB };
+	for (int l = 0; l < 5; l++)
+	    out << "," << (s.forwarded_flits[links[l]] - p.forwarded_flits[links[l]]) / interval;
+
+	out << "," << s.dynamic_energy - p.dynamic_energy << "\n";
+
+	p = s;
+    }
+
+    out.flush();
+}
@@ -0,0 +1,53 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the periodic telemetry
+ */
+
+#ifndef __NOXIMTELEMETRY_H__
+#define __NOXIMTELEMETRY_H__
+
+#include <fstream>
+#include <vector>
+#include <systemc.h>
+#include "NoC.h"
+
+using namespace std;
+
+// Counters of a router at the previous sample
+struct RouterSample {
+    unsigned long forwarded_flits[DIRECTIONS + 2];
+    unsigned long injected_flits;
+    unsigned long ejected_packets;
+    double ejected_delay;
+    double dynamic_energy;
+};
+
+// Telemetry -- every GlobalParams::telemetry_interval cycles after the
+// reset, writes a CSV line for each router with its activity in the last
+// interval. The routers are read half a cycle after the clock edge, when
+// all the modules have been evaluated, so the samples do not depend on
+// the kernel in use and nothing is done between two samples
+SC_MODULE(Telemetry)
+{
+    SC_HAS_PROCESS(Telemetry);
+
+    Telemetry(sc_module_name nm, NoC * _noc);
+
+    void process();
+
+  private:
+
+    void sample(const unsigned long cycle);
+
+    NoC *noc;
+    vector < Router * >routers;
+    vector < RouterSample > previous;
+    ofstream out;
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include <systemc.h>
 #include "Router.h"
 #include "ProcessingElement.h"
+#include "FastSignal.h"
 using namespace std;
 
 SC_MODULE(Tile)
@@ -56,19 +57,19 @@ SC_MODULE(Tile)
     sc_out < NoP_data > NoP_data_out[DIRECTIONS];
     sc_in < NoP_data > NoP_data_in[DIRECTIONS];
 
-    sc_signal <int> free_slots_local;
-    sc_signal <int> free_slots_neighbor_local;
+    FastSignal <int> free_slots_local;
+    FastSignal <int> free_slots_neighbor_local;
 
     // Signals required for Router-PE connection
-    sc_signal <Flit> flit_rx_local;	
-    sc_signal <bool> req_rx_local;     
-    sc_signal <bool> ack_rx_local;
-    sc_signal <TBufferFullStatus> buffer_full_status_rx_local;
-
-    sc_signal <Flit> flit_tx_local;
-    sc_signal <bool> req_tx_local;
-    sc_signal <bool> ack_tx_local;
-    sc_signal <TBufferFullStatus> buffer_full_status_tx_local;
+    FastSignal <Flit> flit_rx_local;	
+    FastSignal <bool> req_rx_local;     
+    FastSignal <bool> ack_rx_local;
+    FastSignal <TBufferFullStatus> buffer_full_status_rx_local;
+
+    FastSignal <Flit> flit_tx_local;
+    FastSignal <bool> req_tx_local;
+    FastSignal <bool> ack_tx_local;
+    FastSignal <TBufferFullStatus> buffer_full_status_tx_local;
 
 
     // Instances
@@ -10,119 +10,197 @@
 
 #include "TokenRing.h"
 
-void TokenRing::updateTokenPacket(int channel)
+void TokenRing::passToken(Ring & ring, int position)
 {
-    int token_pos = token_position[channel];
-    int token_holder = rings_mapping[channel][token_pos];
-    // TEST HOLD BUG
-	//if (flag[channel][token_pos]->read() == RELEASE_CHANNEL)
+    ring.token_position = position;
 
-    if (flag[channel][token_holder]->read() == RELEASE_CHANNEL)
-	{
-	    // number of hubs of the ring
-	    int num_hubs = rings_mapping[channel].size();
-
-	    token_position[channel] = (token_position[channel]+1)%num_hubs;
-
-	    int new_token_holder = rings_mapping[channel][token_position[channel]];
-        LOG << "*** Token of channel " << channel << " has been assigned to Hub_" <<  new_token_holder << endl;
-	    current_token_holder[channel]->write(new_token_holder);
-	    // TEST HOLD BUG
-	    //flag[channel][token_position[channel]]->write(HOLD_CHANNEL);
-        flag[channel][new_token_holder]->write(HOLD_CHANNEL);
-	}
+    int new_token_holder = ring.hubs[ring.token_position];
+    LOG << "*** Token of channel " << ring.channel << " has been assigned to Hub_" <<  new_token_holder << endl;
+    ring.current_token_holder->write(new_token_holder);
 }
 
-void TokenRing::updateTokenMaxHold(int channel)
+void TokenRing::advanceToken(Ring & ring)
 {
-	if (--token_hold_count[channel] == 0 ||
-		flag[channel][token_position[channel]]->read() == RELEASE_CHANNEL)
-	{
-	    token_hold_count[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
-	    // number of hubs of the ring
-	    int num_hubs = rings_mapping[channel].size();
+    // number of hubs of the ring
+    int num_hubs = ring.hubs.size();
 
-	    token_position[channel] = (token_position[channel]+1)%num_hubs;
-	    LOG << "*** Token of channel " << channel << " has been assigned to Hub_" <<  rings_mapping[channel][token_position[channel]] << endl;
+    passToken(ring, (ring.token_position+1)%num_hubs);
+}
 
-	    current_token_holder[channel]->write(rings_mapping[channel][token_position[channel]]);
-	}
+void TokenRing::publishExpiration(Ring & ring)
+{
+    // hubs see the new holder from the cycle after the update
+    ring.current_token_expiration->write(ring.expiration + 1);
+}
 
-	current_token_expiration[channel]->write(token_hold_count[channel]);
+long TokenRing::currentCycle()
+{
+    return (long)(sc_time_stamp().to_double() / GlobalParams::clock_period_ps);
 }
 
-void TokenRing::updateTokenHold(int channel)
+void TokenRing::updateRing(Ring & ring, long now)
 {
-	if (--token_hold_count[channel] == 0)
-	{
-	    token_hold_count[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
-	    // number of hubs of the ring
-	    int num_hubs = rings_mapping[channel].size();
+    bool release = false;
 
-	    token_position[channel] = (token_position[channel]+1)%num_hubs;
-	    LOG << "*** Token of channel " << channel << " has been assigned to Hub_" <<  rings_mapping[channel][token_position[channel]] << endl;
+    if (ring.pending_ticks > 0)
+    {
+	release = (ring.flag[ring.token_position]->read() == RELEASE_CHANNEL);
 
-	    current_token_holder[channel]->write(rings_mapping[channel][token_position[channel]]);
-	}
+	if (--ring.pending_ticks == 0)
+	    pending--;
+    }
 
-	current_token_expiration[channel]->write(token_hold_count[channel]);
+    if (ring.policy == MAC_TOKEN_PACKET)
+    {
+	if (release)
+	{
+	    advanceToken(ring);
+	    ring.flag[ring.token_position]->write(HOLD_CHANNEL);
+	}
+    }
+    else if (ring.policy == MAC_TOKEN_DEMAND)
+    {
+	// A released token goes to the first hub requesting it after the
+	// holder, which is the last one checked. Without requests it is
+	// left to the holder until a hub asks for it
+	if (release)
+	{
+	    int num_hubs = ring.hubs.size();
+
+	    for (int i = 1; i <= num_hubs; i++)
+	    {
+		int position = (ring.token_position + i) % num_hubs;
+
+		if (ring.request[position]->read())
+		{
+		    passToken(ring, position);
+		    ring.flag[position]->write(HOLD_CHANNEL);
+		    break;
+		}
+	    }
+	}
+    }
+    else if (now >= ring.expiration || (ring.policy == MAC_TOKEN_MAX_HOLD && release))
+    {
+	advanceToken(ring);
+	ring.expiration = now + ring.max_hold_cycles;
+	publishExpiration(ring);
+    }
 }
 
 void TokenRing::updateTokens()
 {
     if (reset.read()) {
-        for (map<int,ChannelConfig>::iterator i = GlobalParams::channel_configuration.begin();
-             i!=GlobalParams::channel_configuration.end();
-             i++)
-            current_token_holder[i->first]->write(rings_mapping[i->first][0]);
+        for (unsigned int i = 0; i < rings.size(); i++)
+        {
+            rings[i].token_position = 0;
+            rings[i].current_token_holder->write(rings[i].hubs[0]);
+        }
+        return;
     }
-    else
+
+    long now = currentCycle();
+
+    next_expiration = LONG_MAX;
+
+    for (unsigned int channel = 0; channel < ring_of_channel.size(); channel++)
     {
+        if (ring_of_channel[channel] == NOT_VALID)
+            continue;
 
-        for (map<int,ChannelConfig>::iterator i = GlobalParams::channel_configuration.begin(); i!=GlobalParams::channel_configuration.end(); i++)
+        Ring & ring = rings[ring_of_channel[channel]];
+
+        updateRing(ring, now);
+
+        if (ring.policy == MAC_TOKEN_HOLD || ring.policy == MAC_TOKEN_MAX_HOLD)
+            next_expiration = min(next_expiration, ring.expiration);
+    }
+}
+
+void TokenRing::tokenProcess()
+{
+    double period = GlobalParams::clock_period_ps;
+
+    while (true)
+    {
+        // Rings are left alone until a holder releases a token, a hub
+        // asks for one or a token expires. The wake up for an expiration
+        // comes half a cycle before its edge, so that the update is
+        // carried out at the edge along with the hubs. A release raised
+        // by an initiator just before an edge is read at that very edge
+        if (pending > 0)
+            wait();
+        else
         {
-            int channel = i->first;
-            //int channel_holder;
-            //channel_holder = current_token_holder[channel]->read();
-
-            string macPolicy = getPolicy(channel).first;
-
-            if (macPolicy == TOKEN_PACKET)
-                updateTokenPacket(channel);
-            else if (macPolicy == TOKEN_HOLD)
-                updateTokenHold(channel);
-            else if (macPolicy == TOKEN_MAX_HOLD)
-                updateTokenMaxHold(channel);
-            else
-                assert(false);
+            if (next_expiration != LONG_MAX)
+                update_event.notify(sc_time((next_expiration - 0.5) * period, SC_PS) - sc_time_stamp());
+
+            wait(update_event);
+
+            if (!clock.posedge())
+                wait();
         }
+
+        updateTokens();
     }
 }
 
+void TokenRing::fastKernelProcess()
+{
+    if (pending > 0 || currentCycle() >= next_expiration)
+        updateTokens();
+}
+
+void TokenRing::notifyPending(Ring & ring)
+{
+    // Flags and requests are read at the next update or, when the hub
+    // has been evaluated before the ring in the same delta cycle, at the
+    // one after
+    if (ring.pending_ticks == 0)
+        pending++;
+    ring.pending_ticks = 2;
+
+    update_event.notify(SC_ZERO_TIME);
+}
+
+void TokenRing::notifyRelease(int channel)
+{
+    notifyPending(rings[ring_of_channel[channel]]);
+}
+
+void TokenRing::notifyRequest(int channel)
+{
+    notifyPending(rings[ring_of_channel[channel]]);
+}
 
-void TokenRing::attachHub(int channel, int hub, sc_in<int>* hub_token_holder_port, sc_in<int>* hub_token_expiration_port, sc_inout<int>* hub_flag_port)
+void TokenRing::attachHub(int channel, int hub, sc_in<int>* hub_token_holder_port, sc_in<int>* hub_token_expiration_port, sc_inout<int>* hub_flag_port, sc_out<bool>* hub_request_port)
 {
-    // If port for requested channel is not present, create the
-    // port and connect a signal
-    if (!current_token_holder[channel])
+    if (channel >= (int)ring_of_channel.size())
+        ring_of_channel.resize(channel + 1, NOT_VALID);
+
+    // If the ring of the requested channel is not present, create its
+    // ports and connect a signal to them
+    if (ring_of_channel[channel] == NOT_VALID)
     {
-        token_position[channel] = 0;
-        // TEST HOLDBUG
-        //token_position[channel] = hub;
-        current_token_holder[channel] = new sc_out<int>();
-        current_token_expiration[channel] = new sc_out<int>();
+        Ring ring;
 
-        token_holder_signals[channel] = new sc_signal<int>();
-        token_expiration_signals[channel] = new sc_signal<int>();
+        ring.channel = channel;
+        ring.policy = getMacPolicy(channel);
+        ring.max_hold_cycles = 0;
+        ring.token_position = 0;
+        ring.expiration = LONG_MAX;
+        ring.pending_ticks = 0;
 
-        current_token_holder[channel]->bind(*(token_holder_signals[channel]));
-        current_token_expiration[channel]->bind(*(token_expiration_signals[channel]));
+        ring.current_token_holder = new sc_out<int>();
+        ring.current_token_expiration = new sc_out<int>();
 
-        // initial value that will be overwritten if mac policy != TOKEN_PACKET
-        token_hold_count[channel] = 0;
+        ring.token_holder_signal = new sc_signal<int>();
+        ring.token_expiration_signal = new sc_signal<int>();
 
+        ring.current_token_holder->bind(*(ring.token_holder_signal));
+        ring.current_token_expiration->bind(*(ring.token_expiration_signal));
 
-        if (GlobalParams::channel_configuration[channel].macPolicy[0] != TOKEN_PACKET) {
+        if (ring.policy == MAC_TOKEN_HOLD || ring.policy == MAC_TOKEN_MAX_HOLD) {
             // checking max hold cycles vs wireless transmission latency
             // consistency
             //TODO move this check: max_hold_cycles depends on the Channel not on the Hub
@@ -131,25 +209,38 @@ void TokenRing::attachHub(int channel, int hub, sc_in<int>* hub_token_holder_por
             int max_hold_cycles = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
             assert(cycles< max_hold_cycles);
 
-            token_hold_count[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
+            // the first holder keeps the token for max_hold_cycles out
+            // of the reset
+            ring.max_hold_cycles = max_hold_cycles;
+            ring.expiration = GlobalParams::reset_time + max_hold_cycles;
+            next_expiration = min(next_expiration, ring.expiration);
+            publishExpiration(ring);
         }
+
+        ring_of_channel[channel] = rings.size();
+        rings.push_back(ring);
     }
 
-    flag[channel][hub] = new sc_inout<int>();
-    flag_signals[channel][hub] = new sc_signal<int>();
-    flag[channel][hub]->bind(*(flag_signals[channel][hub]));
-    hub_flag_port->bind(*(flag_signals[channel][hub]));
+    Ring & ring = rings[ring_of_channel[channel]];
+
+    sc_inout<int> * flag = new sc_inout<int>();
+    sc_signal<int> * flag_signal = new sc_signal<int>();
+    flag->bind(*flag_signal);
+    hub_flag_port->bind(*flag_signal);
+    ring.flag.push_back(flag);
+
+    sc_in<bool> * request = new sc_in<bool>();
+    sc_signal<bool> * request_signal = new sc_signal<bool>();
+    request->bind(*request_signal);
+    hub_request_port->bind(*request_signal);
+    ring.request.push_back(request);
 
     // Connect tokenring to hub
-    hub_token_holder_port->bind(*(token_holder_signals[channel]));
-    hub_token_expiration_port->bind(*(token_expiration_signals[channel]));
+    hub_token_holder_port->bind(*(ring.token_holder_signal));
+    hub_token_expiration_port->bind(*(ring.token_expiration_signal));
 
     //LOG << "Attaching Hub " << hub << " to the token ring for channel " << channel << endl;
-    rings_mapping[channel].push_back(hub);
+    ring.hubs.push_back(hub);
 
-    // TEST HOLD BUG
-    int starting_hub = rings_mapping[channel][0];
-    current_token_holder[channel]->write(starting_hub);
+    ring.current_token_holder->write(ring.hubs[0]);
 }
-
-
@@ -15,6 +15,7 @@
 
 #include "Utils.h"
 #include <stdlib.h>
+#include <climits>
 
 using namespace std;
 
@@ -27,54 +28,96 @@ SC_MODULE(TokenRing)
     sc_in_clk clock;	
     sc_in < bool > reset;
 
-    map<int, sc_out<int>* > current_token_holder;
-    map<int, sc_out<int>* > current_token_expiration;
-    map<int, map<int,sc_inout<int>* > > flag;
+    void attachHub(int channel, int hub, sc_in<int>* hub_token_holder_port, sc_in<int>* hub_token_expiration_port, sc_inout<int>* hub_flag_port, sc_out<bool>* hub_request_port);
 
-    map<int, sc_signal<int>* > token_holder_signals;
-    map<int, sc_signal<int>* > token_expiration_signals;
-    map<int, map<int, sc_signal<int>* > > flag_signals;
+    // Called by the token holder of a channel when it raises
+    // RELEASE_CHANNEL on its flag
+    void notifyRelease(int channel);
 
-
-
-    void attachHub(int channel, int hub, sc_in<int>* hub_token_holder_port, sc_in<int>* hub_token_expiration_port, sc_inout<int>* hub_flag_port);
+    // Called by a hub when it raises its request for the token of a
+    // channel (TOKEN_DEMAND)
+    void notifyRequest(int channel);
 
     void updateTokens();
+    void tokenProcess();
+
+    // Fast kernel: steps the rings in the cycles in which tokenProcess
+    // would have been woken up
+    void fastKernelProcess();
 
     TokenRing(sc_module_name nm): sc_module(nm) {
 
 
-	if (GlobalParams::use_winoc)
+	if (GlobalParams::use_winoc && !GlobalParams::fast_kernel)
 	{
-	    SC_METHOD(updateTokens);
-	    sensitive << reset;
+	    SC_THREAD(tokenProcess);
 	    sensitive << clock.pos();
 	}
 
+        next_expiration = LONG_MAX;
+        pending = 0;
+
+        // policies are resolved once, when the rings are built
         for (map<int, ChannelConfig>::iterator i = GlobalParams::channel_configuration.begin(); 
                 i != GlobalParams::channel_configuration.end();
                 ++i) {
-            token_policy[i->first] = make_pair(i->second.macPolicy[0], i->second.macPolicy); 
+            string policy = i->second.macPolicy.empty() ? "" : i->second.macPolicy[0];
+
+            if (policy == TOKEN_PACKET)
+                mac_policy[i->first] = MAC_TOKEN_PACKET;
+            else if (policy == TOKEN_HOLD)
+                mac_policy[i->first] = MAC_TOKEN_HOLD;
+            else if (policy == TOKEN_MAX_HOLD)
+                mac_policy[i->first] = MAC_TOKEN_MAX_HOLD;
+            else if (policy == TOKEN_DEMAND)
+                mac_policy[i->first] = MAC_TOKEN_DEMAND;
+            else
+            {
+                cerr << "Error: invalid MAC policy '" << policy << "' for channel " << i->first << endl;
+                exit(1);
+            }
         }
     }
 
-    pair<string, vector<string> > getPolicy(int channel) { return token_policy[channel];}
+    MacPolicy getMacPolicy(int channel) { return mac_policy.at(channel); }
 
     private:
 
-    void updateTokenMaxHold(int channel);
-    void updateTokenHold(int channel);
-    void updateTokenPacket(int channel);
-
-    // ring of a channel -> list of pairs < hubs , hold counts >
-    map<int,vector<int> > rings_mapping;
-
-    // ring of a channel -> token position in the ring
-    map<int,int> token_position;
-    
-    map<int,int> token_hold_count;
-
-    map<int,pair<string, vector<string> > >token_policy;
+    // Token ring of a channel
+    struct Ring {
+	int channel;
+	MacPolicy policy;
+	int max_hold_cycles;
+
+	vector<int> hubs;	// Hubs in token order
+	vector<sc_inout<int>* > flag;	// Flag of each hub of the ring
+	vector<sc_in<bool>* > request;	// Hubs with flits to transmit (TOKEN_DEMAND)
+	int token_position;
+
+	sc_out<int> * current_token_holder;
+	sc_out<int> * current_token_expiration;
+	sc_signal<int> * token_holder_signal;
+	sc_signal<int> * token_expiration_signal;
+
+	long expiration;	// Cycle in which the token moves (hold policies)
+	int pending_ticks;	// Updates in which a release or a request can still be read
+    };
+
+    void updateRing(Ring & ring, long now);
+    void passToken(Ring & ring, int position);
+    void advanceToken(Ring & ring);
+    void notifyPending(Ring & ring);
+    void publishExpiration(Ring & ring);
+    long currentCycle();
+
+    vector<Ring> rings;
+    vector<int> ring_of_channel;	// NOT_VALID if no hub transmits on the channel
+
+    long next_expiration;	// Earliest expiration of the hold policies
+    int pending;		// Rings whose pending_ticks is not zero
+    sc_event update_event;	// Wakes up tokenProcess
+
+    map<int, MacPolicy> mac_policy;
 
 };
 
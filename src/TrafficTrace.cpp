@@ -0,0 +1,163 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the packet trace replayed by
+ * the TRAFFIC_TRACE distribution
+ */
+
+#include "TrafficTrace.h"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+TrafficTrace::TrafficTrace()
+{
+    mapped = NULL;
+    mapped_size = 0;
+    sections = NULL;
+    records = NULL;
+    n_sources = 0;
+}
+
+TrafficTrace::~TrafficTrace()
+{
+    unload();
+}
+
+void TrafficTrace::unload()
+{
+    if (mapped)
+	munmap(mapped, mapped_size);
+
+    mapped = NULL;
+    mapped_size = 0;
+    sections = NULL;
+    records = NULL;
+    n_sources = 0;
+}
+
+bool TrafficTrace::load(const char *fname)
+{
+    unload();
+
+    int fd = open(fname, O_RDONLY);
+
+    if (fd < 0)
+	return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(TraceHeader))
+    {
+	cerr << "Error: truncated traffic trace " << fname << endl;
+	close(fd);
+	return false;
+    }
+
+    // only the pages around the cursors of the PEs are resident, they are
+    // read from the file as the simulation goes on
+    mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+	mapped = NULL;
+	cerr << "Error: cannot map traffic trace " << fname << endl;
+	return false;
+    }
+
+    mapped_size = st.st_size;
+
+    const TraceHeader * header = (const TraceHeader *) mapped;
+
+    if (memcmp(header->magic, TRAFFIC_TRACE_MAGIC, sizeof(header->magic)) != 0)
+    {
+	cerr << "Error: " << fname << " is not a traffic trace (compile it with trace2bin)" << endl;
+	unload();
+	return false;
+    }
+
+    if (header->version != TRAFFIC_TRACE_VERSION)
+    {
+	cerr << "Error: traffic trace " << fname << " has version " << header->version
+	     << ", expected " << TRAFFIC_TRACE_VERSION << " (recompile it with trace2bin)" << endl;
+	unload();
+	return false;
+    }
+
+    size_t records_offset = sizeof(TraceHeader) + (size_t) header->n_sources * sizeof(TraceSection);
+
+    if (mapped_size < records_offset)
+    {
+	cerr << "Error: truncated traffic trace " << fname << endl;
+	unload();
+	return false;
+    }
+
+    n_sources = header->n_sources;
+    sections = (const TraceSection *) ((const char *) mapped + sizeof(TraceHeader));
+    records = (const TraceRecord *) ((const char *) mapped + records_offset);
+
+    uint64_t n_records = (mapped_size - records_offset) / sizeof(TraceRecord);
+
+    for (int i = 0; i < n_sources; i++)
+	if (sections[i].first + sections[i].count > n_records)
+	{
+	    cerr << "Error: truncated traffic trace " << fname << endl;
+	    unload();
+	    return false;
+	}
+
+    return true;
+}
+
+unsigned long TrafficTrace::packetsOfSource(const int src_id) const
+{
+    if (src_id < 0 || src_id >= n_sources)
+	return 0;
+
+    return sections[src_id].count;
+}
+
+void TrafficTrace::rewind(TraceCursor & cursor, const int src_id) const
+{
+    if (src_id < 0 || src_id >= n_sources)
+    {
+	cursor.next = cursor.end = cursor.released = NULL;
+	return;
+    }
+
+    cursor.next = records + sections[src_id].first;
+    cursor.end = cursor.next + sections[src_id].count;
+    cursor.released = cursor.next;
+}
+
+void TrafficTrace::advance(TraceCursor & cursor) const
+{
+    cursor.next++;
+
+    size_t consumed = (const char *) cursor.next - (const char *) cursor.released;
+
+    if (consumed < TRAFFIC_TRACE_RELEASE_BYTES && !cursor.done())
+	return;
+
+    // whole pages only: a page shared with a neighbouring section is
+    // simply read again from the file if needed
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t base = (size_t) mapped;
+    size_t from = ((size_t) cursor.released - base + page - 1) / page * page;
+    size_t to = ((size_t) cursor.next - base) / page * page;
+
+    if (to > from)
+    {
+	madvise((char *) mapped + from, to - from, MADV_DONTNEED);
+	cursor.released = (const TraceRecord *) ((const char *) mapped + to);
+    }
+}
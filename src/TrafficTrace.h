@@ -0,0 +1,90 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the packet trace replayed by the
+ * TRAFFIC_TRACE distribution
+ */
+
+#ifndef __NOXIMTRAFFICTRACE_H__
+#define __NOXIMTRAFFICTRACE_H__
+
+#include <cstddef>
+#include <stdint.h>
+
+using namespace std;
+
+// Packet traces (see other/trace2bin.cpp) start with this header, followed
+// by a section descriptor for each source and then by the records, grouped
+// by source and sorted by cycle within each source. Integers are stored in
+// the byte order of the machine which compiled the trace
+#define TRAFFIC_TRACE_MAGIC	"NXTR"
+#define TRAFFIC_TRACE_VERSION	1
+
+struct TraceHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t n_sources;
+    uint32_t reserved;
+};
+
+// Records of a source: indexes of the first one and number of records
+struct TraceSection {
+    uint64_t first;
+    uint64_t count;
+};
+
+// A packet of the trace. The cycle is counted from the end of the reset
+struct TraceRecord {
+    uint32_t cycle;
+    uint16_t dst_id;
+    uint16_t size;		// In flits
+};
+
+// Consumed pages of a section are given back to the kernel in chunks of
+// this size, so that the memory in use does not grow with the trace
+#define TRAFFIC_TRACE_RELEASE_BYTES	(1 << 20)
+
+// TraceCursor -- position of a PE inside its section of the trace
+struct TraceCursor {
+    const TraceRecord *next;	// Next packet to be injected
+    const TraceRecord *end;
+    const TraceRecord *released;	// Records before this have been released
+
+    inline bool done() const { return next == end; }
+};
+
+class TrafficTrace {
+
+  public:
+
+    TrafficTrace();
+    ~TrafficTrace();
+
+    // Maps a trace compiled by trace2bin. Returns true if ok, false otherwise
+    bool load(const char *fname);
+
+    // Number of packets injected by src_id
+    unsigned long packetsOfSource(const int src_id) const;
+
+    // Positions the cursor on the first packet of src_id
+    void rewind(TraceCursor & cursor, const int src_id) const;
+
+    // Moves the cursor to the next packet, releasing the consumed pages
+    void advance(TraceCursor & cursor) const;
+
+  private:
+
+    void unload();
+
+    void *mapped;		// Trace mapped in memory
+    size_t mapped_size;
+    const TraceSection *sections;
+    const TraceRecord *records;
+    int n_sources;
+};
+
+#endif
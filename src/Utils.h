@@ -49,7 +49,9 @@ private:
 typedef basic_onullstream<char> onullstream;
 typedef basic_onullstream<wchar_t> wonullstream;
 
-static onullstream LOG;
+// one stream per thread, as the modules may be evaluated concurrently
+// in parallel mode
+static thread_local onullstream LOG;
 
 #endif
 
@@ -57,12 +59,16 @@ static onullstream LOG;
 
 inline ostream & operator <<(ostream & os, const Flit & flit)
 {
+    if (flit.packet_id == PACKET_NOT_VALID)
+	return os << "(no flit)";
+
+    const PacketDescriptor & packet = flit.packet();
 
     if (GlobalParams::verbose_mode == VERBOSE_HIGH) {
 
 	os << "### FLIT ###" << endl;
-	os << "Source Tile[" << flit.src_id << "]" << endl;
-	os << "Destination Tile[" << flit.dst_id << "]" << endl;
+	os << "Source Tile[" << packet.src_id << "]" << endl;
+	os << "Destination Tile[" << packet.dst_id << "]" << endl;
 	switch (flit.flit_type) {
 	case FLIT_TYPE_HEAD:
 	    os << "Flit Type is HEAD" << endl;
@@ -76,10 +82,10 @@ inline ostream & operator <<(ostream & os, const Flit & flit)
 	}
 	os << "Sequence no. " << flit.sequence_no << endl;
 	os << "Payload printing not implemented (yet)." << endl;
-	os << "Unix timestamp at packet generation " << flit.
+	os << "Unix timestamp at packet generation " << packet.
 	    timestamp << endl;
 	os << "Total number of hops from source to destination is " <<
-	    flit.hop_no << endl;
+	    packet.hop_no << endl;
     } else {
 	os << "(";
 	switch (flit.flit_type) {
@@ -94,7 +100,7 @@ inline ostream & operator <<(ostream & os, const Flit & flit)
 	    break;
 	}
 
-	os <<  flit.sequence_no << ", " << flit.src_id << "->" << flit.dst_id << " VC " << flit.vc_id << ")";
+	os <<  flit.sequence_no << ", " << packet.src_id << "->" << packet.dst_id << " VC " << packet.vc_id << ")";
     }
 
     return os;
@@ -141,13 +147,12 @@ inline ostream & operator <<(ostream & os, const Coord & coord)
 
 // Trace overloading
 
+// The descriptor of the packet may be released while the flit is still
+// on the signal, only the fields of the flit itself are traced
 inline void sc_trace(sc_trace_file * &tf, const Flit & flit, string & name)
 {
-    sc_trace(tf, flit.src_id, name + ".src_id");
-    sc_trace(tf, flit.dst_id, name + ".dst_id");
+    sc_trace(tf, flit.packet_id, name + ".packet_id");
     sc_trace(tf, flit.sequence_no, name + ".sequence_no");
-    sc_trace(tf, flit.timestamp, name + ".timestamp");
-    sc_trace(tf, flit.hop_no, name + ".hop_no");
 }
 
 inline void sc_trace(sc_trace_file * &tf, const NoP_data & NoP_data, string & name)
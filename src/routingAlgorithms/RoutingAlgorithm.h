@@ -1,7 +1,6 @@
 #ifndef __NOXIMROUTINGALGORITHM_H__
 #define __NOXIMROUTINGALGORITHM_H__
 
-#include <vector>
 #include "../DataStructs.h"
 #include "../Utils.h"
 
@@ -12,7 +11,14 @@ struct Router;
 class RoutingAlgorithm
 {
 	public:
-		virtual vector<int> route(Router * router, const RouteData & routeData) = 0;
+		virtual DirectionSet route(Router * router, const RouteData & routeData) = 0;
+
+		// True if route() depends only on the current node and on the
+		// destination, and on the mesh only on the sides of the current
+		// node the destination lies (west, same column or east, and north,
+		// same row or south): each router then evaluates it once for each
+		// of them at configuration (see Router::buildRouteLUT)
+		virtual bool isPrecomputable() const { return false; }
 };
 
 #endif
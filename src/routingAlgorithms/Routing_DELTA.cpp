@@ -11,9 +11,9 @@ Routing_DELTA * Routing_DELTA::getInstance() {
     return routing_DELTA;
 }
 
-vector<int> Routing_DELTA::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_DELTA::route(Router * router, const RouteData & routeData)
 {
-    vector <int> directions;
+    DirectionSet directions;
 
    // int switch_offset = GlobalParams::n_delta_tiles;
 
@@ -10,7 +10,8 @@ using namespace std;
 
 class Routing_DELTA : RoutingAlgorithm {
 	public:
-		vector<int> route(Router * router, const RouteData & routeData);
+		DirectionSet route(Router * router, const RouteData & routeData);
+		bool isPrecomputable() const { return true; }
 
 		static Routing_DELTA * getInstance();
 
@@ -12,9 +12,9 @@ Routing_DYAD * Routing_DYAD::getInstance() {
     return routing_DYAD;
 }
 
-vector<int> Routing_DYAD::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_DYAD::route(Router * router, const RouteData & routeData)
 {
-    vector <int> directions;
+    DirectionSet directions;
 
     if (!odd_even)
     {
@@ -26,7 +26,7 @@ vector<int> Routing_DYAD::route(Router * router, const RouteData & routeData)
 
     directions = odd_even->route(router, routeData);
 
-    if (!router->inCongestion()) directions.resize(1);
+    if (!router->inCongestion()) directions.truncate(1);
 
     return directions;
 }
@@ -9,7 +9,7 @@ using namespace std;
 
 class Routing_DYAD : RoutingAlgorithm {
 	public:
-		vector<int> route(Router * router, const RouteData & routeData);
+		DirectionSet route(Router * router, const RouteData & routeData);
 
 		static Routing_DYAD * getInstance();
 
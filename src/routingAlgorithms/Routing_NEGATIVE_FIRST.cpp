@@ -12,11 +12,11 @@ Routing_NEGATIVE_FIRST * Routing_NEGATIVE_FIRST::getInstance() {
 	return routing_NEGATIVE_FIRST;
 }
 
-vector<int> Routing_NEGATIVE_FIRST::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_NEGATIVE_FIRST::route(Router * router, const RouteData & routeData)
 {
     Coord current = id2Coord(routeData.current_id);
     Coord destination = id2Coord(routeData.dst_id);
-    vector <int> directions;
+    DirectionSet directions;
     
     // Negative directions:
     // WEST (current x > dest x)
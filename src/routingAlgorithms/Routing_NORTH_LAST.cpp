@@ -12,11 +12,11 @@ Routing_NORTH_LAST * Routing_NORTH_LAST::getInstance() {
     return routing_NORTH_LAST;
 }
 
-vector<int> Routing_NORTH_LAST::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_NORTH_LAST::route(Router * router, const RouteData & routeData)
 {
     Coord current = id2Coord(routeData.current_id);
     Coord destination = id2Coord(routeData.dst_id);
-    vector <int> directions;
+    DirectionSet directions;
 
     if (destination.x == current.x || destination.y <= current.y)
     {
@@ -9,7 +9,8 @@ using namespace std;
 
 class Routing_NORTH_LAST : RoutingAlgorithm {
 	public:
-		vector<int> route(Router * router, const RouteData & routeData);
+		DirectionSet route(Router * router, const RouteData & routeData);
+		bool isPrecomputable() const { return true; }
 
 		static Routing_NORTH_LAST * getInstance();
 
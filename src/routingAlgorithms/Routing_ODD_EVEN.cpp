@@ -11,12 +11,12 @@ Routing_ODD_EVEN * Routing_ODD_EVEN::getInstance() {
 	return routing_ODD_EVEN;
 }
 
-vector<int> Routing_ODD_EVEN::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_ODD_EVEN::route(Router * router, const RouteData & routeData)
 {
     Coord current = id2Coord(routeData.current_id);
     Coord destination = id2Coord(routeData.dst_id);
     Coord source = id2Coord(routeData.src_id);
-    vector <int> directions;
+    DirectionSet directions;
 
     int c0 = current.x;
     int c1 = current.y;
@@ -9,7 +9,7 @@ using namespace std;
 
 class Routing_ODD_EVEN : RoutingAlgorithm {
 	public:
-		vector<int> route(Router * router, const RouteData & routeData);
+		DirectionSet route(Router * router, const RouteData & routeData);
 
 		static Routing_ODD_EVEN * getInstance();
         inline string name() { return "Routing_ODD_EVEN";};
@@ -11,21 +11,21 @@ Routing_TABLE_BASED * Routing_TABLE_BASED::getInstance() {
 	return routing_TABLE_BASED;
 }
 
-vector<int> Routing_TABLE_BASED::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_TABLE_BASED::route(Router * router, const RouteData & routeData)
 {
-    Coord current = id2Coord(routeData.current_id);
-    Coord destination = id2Coord(routeData.dst_id);
+    DirectionSet directions = router->routing_table.getAdmissibleDirections(routeData.dir_in, routeData.dst_id);
 
-    AdmissibleOutputs ao = router->routing_table.getAdmissibleOutputs(routeData.dir_in, routeData.dst_id);
+    if (directions.size() == 0) {
+        Coord current = id2Coord(routeData.current_id);
+        Coord destination = id2Coord(routeData.dst_id);
 
-    if (ao.size() == 0) {
         LOG << "dir: " << routeData.dir_in << ", (" << current.x << "," << current.
             y << ") --> " << "(" << destination.x << "," << destination.
             y << ")" << endl << routeData.current_id << "->" <<
             routeData.dst_id << endl;
     }
 
-    assert(ao.size() > 0);
+    assert(directions.size() > 0);
 
-    return admissibleOutputsSet2Vector(ao);
+    return directions;
 }
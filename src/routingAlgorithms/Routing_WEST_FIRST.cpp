@@ -12,11 +12,11 @@ Routing_WEST_FIRST * Routing_WEST_FIRST::getInstance() {
     return routing_WEST_FIRST;
 }
 
-vector<int> Routing_WEST_FIRST::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_WEST_FIRST::route(Router * router, const RouteData & routeData)
 {
     Coord current = id2Coord(routeData.current_id);
     Coord destination = id2Coord(routeData.dst_id);
-    vector <int> directions;
+    DirectionSet directions;
 
     if (destination.x <= current.x || destination.y == current.y)
     {
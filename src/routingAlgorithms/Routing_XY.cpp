@@ -11,11 +11,11 @@ Routing_XY * Routing_XY::getInstance() {
 	return routing_XY;
 }
 
-vector<int> Routing_XY::route(Router * router, const RouteData & routeData)
+DirectionSet Routing_XY::route(Router * router, const RouteData & routeData)
 {
     Coord current = id2Coord(routeData.current_id);
     Coord destination = id2Coord(routeData.dst_id);
-    vector <int> directions;
+    DirectionSet directions;
 
     if (destination.x > current.x)
        directions.push_back(DIRECTION_EAST);
@@ -1,7 +1,6 @@
 #ifndef __NOXIMSELECTIONSTRATEGY_H__
 #define __NOXIMSELECTIONSTRATEGY_H__
 
-#include <vector>
 #include "../DataStructs.h"
 #include "../Utils.h"
 
@@ -12,7 +11,7 @@ struct Router;
 class SelectionStrategy
 {
 	public:
-        virtual int apply(Router * router, const vector < int >&directions, const RouteData & route_data) = 0;
+        virtual int apply(Router * router, const DirectionSet & directions, const RouteData & route_data) = 0;
         virtual void perCycleUpdate(Router * router) = 0;
 };
 
@@ -11,8 +11,8 @@ Selection_BUFFER_LEVEL * Selection_BUFFER_LEVEL::getInstance() {
 	return selection_BUFFER_LEVEL;
 }
 
-int Selection_BUFFER_LEVEL::apply(Router * router, const vector < int >&directions, const RouteData & route_data){
-    vector < int >best_dirs;
+int Selection_BUFFER_LEVEL::apply(Router * router, const DirectionSet & directions, const RouteData & route_data){
+    DirectionSet best_dirs;
     int max_free_slots = 0;
     for (unsigned int i = 0; i < directions.size(); i++) {
 
@@ -41,9 +41,9 @@ int Selection_BUFFER_LEVEL::apply(Router * router, const vector < int >&directio
     }
 
     if (best_dirs.size())
-	return (best_dirs[rand() % best_dirs.size()]);
+	return (best_dirs[router->rng.below(best_dirs.size())]);
     else
-	return (directions[rand() % directions.size()]);
+	return (directions[router->rng.below(directions.size())]);
 
     //-------------------------
     // TODO: unfair if multiple directions have same buffer level
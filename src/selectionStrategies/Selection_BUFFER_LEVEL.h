@@ -9,7 +9,7 @@ using namespace std;
 
 class Selection_BUFFER_LEVEL : SelectionStrategy {
 	public:
-        int apply(Router * router, const vector < int >&directions, const RouteData & route_data);
+        int apply(Router * router, const DirectionSet & directions, const RouteData & route_data);
         void perCycleUpdate(Router * router);
 
 		static Selection_BUFFER_LEVEL * getInstance();
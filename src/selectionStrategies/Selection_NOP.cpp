@@ -11,14 +11,13 @@ Selection_NOP * Selection_NOP::getInstance() {
 	return selection_NOP;
 }
 
-int Selection_NOP::apply(Router * router, const vector < int >&directions, const RouteData & route_data) {
-    vector < int >neighbors_on_path;
-    vector < int >score;
+int Selection_NOP::apply(Router * router, const DirectionSet & directions, const RouteData & route_data) {
+    int score[MAX_ADMISSIBLE_DIRECTIONS];
     int direction_selected = NOT_VALID;
 
     int current_id = route_data.current_id;
 
-    for (size_t i = 0; i < directions.size(); i++) {
+    for (unsigned int i = 0; i < directions.size(); i++) {
 	// get id of adjacent candidate
 	int candidate_id = router->getNeighborId(current_id, directions[i]);
 
@@ -30,14 +29,14 @@ int Selection_NOP::apply(Router * router, const vector < int >&directions, const
 	tmp_route_data.dir_in = router->reflexDirection(directions[i]);
 
 
-	vector < int >next_candidate_channels =
+	DirectionSet next_candidate_channels =
 	    router->routingFunction(tmp_route_data);
 
 	// select useful data from Neighbor-on-Path input 
 	NoP_data nop_tmp = router->NoP_data_in[directions[i]].read();
 
 	// store the score of node in the direction[i]
-	score.push_back(router->NoPScore(nop_tmp, next_candidate_channels));
+	score[i] = router->NoPScore(nop_tmp, next_candidate_channels);
     }
 
     // check for direction with higher score
@@ -52,14 +51,14 @@ int Selection_NOP::apply(Router * router, const vector < int >&directions, const
 
     // if multiple direction have the same score = max, choose randomly.
 
-    vector < int >equivalent_directions;
+    DirectionSet equivalent_directions;
 
     for (unsigned int i = 0; i < directions.size(); i++)
 	if (score[i] == max)
 	    equivalent_directions.push_back(directions[i]);
 
     direction_selected =
-	equivalent_directions[rand() % equivalent_directions.size()];
+	equivalent_directions[router->rng.below(equivalent_directions.size())];
 
     return direction_selected;
 }
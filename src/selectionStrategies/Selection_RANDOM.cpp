@@ -11,10 +11,10 @@ Selection_RANDOM * Selection_RANDOM::getInstance() {
 	return selection_RANDOM;
 }
 
-int Selection_RANDOM::apply(Router * router, const vector < int >&directions, const RouteData & route_data){
+int Selection_RANDOM::apply(Router * router, const DirectionSet & directions, const RouteData & route_data){
     assert(directions.size()!=0);
 
-    int output = directions[rand() % directions.size()];
+    int output = directions[router->rng.below(directions.size())];
     return output;
 
 }